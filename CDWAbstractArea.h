@@ -5,18 +5,38 @@
  *      Author: thomas
  */
 
+#ifndef CDWABSTRACTAREA_H_
+#define CDWABSTRACTAREA_H_
+
 #include <Wt/WAbstractArea>
 #include "CDWObject.h"
+#include "CDWString.h"
+#include "CDWStyleClassTokens.h"
+#include "CDWToolTipLoader.h"
+#include "CDWApplication.h"
 
 namespace Wt {
   class CDWAbstractArea : public CDWObject{
   protected:
-    CDWAbstractArea(WAbstractArea* object = 0): CDWObject(object) {}
+    CDWAbstractArea(WAbstractArea* object = 0): CDWObject(object) {
+      if(object)
+        styleTokens.assign(object->styleClass().toUTF8());
+    }
 
     WAbstractArea* getObject() const {
       return static_cast<WAbstractArea*>(wobject);
     }
 
+    friend class CDWAreaOptimizer;
+
+  private:
+    std::string toolTipKeyValue;
+    CDWStyleClassSet styleTokens;
+
+    void applyStyleTokens(){
+      getObject()->setStyleClass(WString::fromUTF8(styleTokens.str()));
+    }
+
   public:
 
     /*! \brief Specifies that this area specifies a hole for another area.
@@ -177,6 +197,9 @@ namespace Wt {
     virtual void setAlternateText(const WString& text){
       getObject()->setAlternateText(text);
     }
+    virtual void setAlternateText(const char* utf8, size_t len){
+      getObject()->setAlternateText(utf8String(utf8, len));
+    }
 
     /*! \brief Returns the alternate text.
      *
@@ -191,15 +214,54 @@ namespace Wt {
      * The tooltip is displayed when the cursor hovers over the area.
      */
     virtual void setToolTip(const WString& text){
+      if(!toolTipKeyValue.empty())
+        setDeferredToolTip("");
       getObject()->setToolTip(text);
     }
+    virtual void setToolTip(const char* utf8, size_t len){
+      setToolTip(utf8String(utf8, len));
+    }
 
     /*! \brief Returns the tooltip text.
      *
      * \sa setToolTip()
      */
     virtual WString toolTip() const{
-      return getObject()->toolTip();
+      return toolTipKeyValue.empty() ? getObject()->toolTip() : WString::Empty;
+    }
+
+    /*! \brief Sets a deferred tooltip.
+     *
+     * Instead of the tooltip text, only \p key is sent to the browser.
+     * The text is resolved through the provider set with
+     * CDWApplication::setToolTipProvider() the first time the user hovers
+     * an area with this key, and is then cached on the client.
+     *
+     * This replaces any tooltip set with setToolTip(). Passing an empty
+     * key disables the deferred tooltip. Keys must not contain newline
+     * characters, these separate keys in a batched request.
+     *
+     * \sa toolTipKey()
+     */
+    virtual void setDeferredToolTip(const char* key){
+      if(toolTipKeyValue == key)
+        return;
+
+      toolTipKeyValue = key;
+      if(toolTipKeyValue.empty()){
+        getObject()->setToolTip(WString::Empty);
+        return;
+      }
+      CDWToolTipLoader::instance();
+      getObject()->setToolTip(WString::fromUTF8(CDWToolTipLoader::marker() + toolTipKeyValue));
+    }
+
+    /*! \brief Returns the deferred tooltip key.
+     *
+     * \sa setDeferredToolTip()
+     */
+    virtual const char* toolTipKey() const{
+      return toolTipKeyValue.c_str();
     }
 
     /*! \brief Defines a style class.
@@ -209,10 +271,16 @@ namespace Wt {
      *       will simply be ignored.
      */
     virtual void setStyleClass(const WString& styleClass){
-      return getObject()->setStyleClass(styleClass);
+      if(styleTokens.assign(styleClass.toUTF8()))
+        applyStyleTokens();
     }
     virtual void setStyleClass(const char* styleClass){
-      return getObject()->setStyleClass(styleClass);
+      if(styleTokens.assign(styleClass))
+        applyStyleTokens();
+    }
+    virtual void setStyleClass(const char* utf8, size_t len){
+      if(styleTokens.assign(std::string(utf8, len)))
+        applyStyleTokens();
     }
 
     /*! \brief Returns the style class.
@@ -230,13 +298,70 @@ namespace Wt {
      *       will simply be ignored.
      */
     virtual void addStyleClass(const WString& styleClass, bool force = false){
-      getObject()->addStyleClass(styleClass, force);
+      if(styleTokens.add(styleClass.toUTF8()) || force)
+        applyStyleTokens();
+    }
+    virtual void addStyleClass(const char* utf8, size_t len, bool force){
+      if(styleTokens.add(std::string(utf8, len)) || force)
+        applyStyleTokens();
     }
 
     /*! \brief Removes a style class.
      */
     virtual void removeStyleClass(const WString& styleClass, bool force = false){
-      getObject()->removeStyleClass(styleClass, force);
+      if(styleTokens.remove(styleClass.toUTF8()) || force)
+        applyStyleTokens();
+    }
+    virtual void removeStyleClass(const char* utf8, size_t len, bool force){
+      if(styleTokens.remove(std::string(utf8, len)) || force)
+        applyStyleTokens();
+    }
+
+    /*! \brief Adds an interned style class.
+     *
+     * The class string is only rebuilt when the set of classes actually
+     * changes.
+     *
+     * \sa CDWStyleClassTokens::intern()
+     */
+    virtual void addStyleToken(CDWStyleToken token){
+      if(styleTokens.add(token))
+        applyStyleTokens();
+    }
+
+    /*! \brief Removes an interned style class.
+     */
+    virtual void removeStyleToken(CDWStyleToken token){
+      if(styleTokens.remove(token))
+        applyStyleTokens();
+    }
+
+    /*! \brief Adds or removes an interned style class.
+     */
+    virtual void toggleStyleToken(CDWStyleToken token, bool enabled){
+      if(enabled ? styleTokens.add(token) : styleTokens.remove(token))
+        applyStyleTokens();
+    }
+
+    /*! \brief Returns whether an interned style class is set.
+     */
+    virtual bool hasStyleToken(CDWStyleToken token) const{
+      return styleTokens.contains(token);
+    }
+
+    /*! \brief Adds and removes several interned style classes at once.
+     *
+     * The class string is rebuilt at most once.
+     */
+    virtual void updateStyleTokens(const CDWStyleToken* add, size_t nAdd,
+                                   const CDWStyleToken* remove, size_t nRemove){
+      bool changed = false;
+      for(size_t i = 0; i < nRemove; ++i)
+        changed = styleTokens.remove(remove[i]) || changed;
+      for(size_t i = 0; i < nAdd; ++i)
+        changed = styleTokens.add(add[i]) || changed;
+      if(changed)
+        applyStyleTokens();
     }
 
     /*! \brief Sets the cursor.
@@ -455,3 +580,4 @@ namespace Wt {
   };
 }
 
+#endif /* CDWABSTRACTAREA_H_ */
@@ -0,0 +1,230 @@
+/*
+ * CDWAdmission.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWADMISSION_H_
+#define CDWADMISSION_H_
+
+#include <Wt/WApplication>
+#include <Wt/WText>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Wt {
+  class CDWApplication;
+
+  /*! \brief Load and admission statistics, process-wide.
+   */
+  struct CDWAdmissionStats{
+    int inFlight;            //!< Events being handled
+    long queueDepth;         //!< Closures queued in session executors
+    int p99;                 //!< Recent 99th percentile event latency, in ms
+    int maxInFlight;         //!< Limit on inFlight, 0 if none
+    long maxQueueDepth;      //!< Limit on queueDepth, 0 if none
+    int maxP99;              //!< Limit on p99, 0 if none
+    std::uint64_t admitted;  //!< Sessions constructed normally
+    std::uint64_t rejected;  //!< Sessions served the busy page
+  };
+
+  /*! \brief Sheds new sessions while the server is overloaded.
+   *
+   * construct(const WEnvironment&) asks admit() before building an
+   * application. While one of the configured limits is exceeded, a new
+   * session gets a CDWBusyApplication instead: a single static message,
+   * after which the session ends. Existing sessions keep the capacity.
+   *
+   * The load is measured by CDWApplicationImpl (events in flight and their
+   * latency) and CDWSessionExecutor (queued closures). The p99 latency is
+   * computed over the last samples() events that finished within the
+   * last 10 seconds, at most every 250 ms: once traffic stops, old
+   * latency spikes age out.
+   *
+   * All limits are off by default.
+   */
+  class CDWAdmission{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    static void setMaxInFlight(int events){
+      instance().maxInFlight.store(events, std::memory_order_relaxed);
+    }
+
+    static void setMaxQueueDepth(long closures){
+      instance().maxQueueDepth.store(closures, std::memory_order_relaxed);
+    }
+
+    /*! \brief Sets the limit on the recent p99 event latency, in
+     *         milliseconds.
+     */
+    static void setMaxP99(int milliSeconds){
+      instance().maxP99.store(milliSeconds, std::memory_order_relaxed);
+    }
+
+    /*! \brief Sets the text shown to sessions that are not admitted.
+     */
+    static void setBusyMessage(const std::string& utf8){
+      CDWAdmission& a = instance();
+      std::lock_guard<std::mutex> lock(a.mutex);
+      a.busyMessageValue = utf8;
+    }
+
+    static std::string busyMessage(){
+      CDWAdmission& a = instance();
+      std::lock_guard<std::mutex> lock(a.mutex);
+      return a.busyMessageValue;
+    }
+
+    /*! \brief Returns whether a new session may be constructed.
+     */
+    static bool admit(){
+      CDWAdmission& a = instance();
+      int maxEvents = a.maxInFlight.load(std::memory_order_relaxed);
+      long maxQueue = a.maxQueueDepth.load(std::memory_order_relaxed);
+      int maxLatency = a.maxP99.load(std::memory_order_relaxed);
+
+      bool ok = (maxEvents <= 0 || a.inFlight.load(std::memory_order_relaxed) < maxEvents)
+        && (maxQueue <= 0 || a.queueDepth.load(std::memory_order_relaxed) < maxQueue)
+        && (maxLatency <= 0 || p99() < maxLatency);
+
+      (ok ? a.admittedCount : a.rejectedCount).fetch_add(1, std::memory_order_relaxed);
+      return ok;
+    }
+
+    /*! \brief Registers the start of an event, returns its start time.
+     */
+    static Clock::time_point eventStarted(){
+      instance().inFlight.fetch_add(1, std::memory_order_relaxed);
+      return Clock::now();
+    }
+
+    /*! \brief Registers the end of an event.
+     */
+    static void eventFinished(Clock::time_point started){
+      CDWAdmission& a = instance();
+      a.inFlight.fetch_sub(1, std::memory_order_relaxed);
+      Clock::time_point now = Clock::now();
+      std::chrono::milliseconds ms
+        = std::chrono::duration_cast<std::chrono::milliseconds>(now - started);
+      std::size_t slot = a.next.fetch_add(1, std::memory_order_relaxed) % Samples;
+      a.latencies[slot].store((std::uint32_t)std::min<long long>(ms.count(), 0xffffffffLL),
+                              std::memory_order_relaxed);
+      a.finished[slot].store(now.time_since_epoch().count(), std::memory_order_relaxed);
+    }
+
+    /*! \brief Adjusts the number of queued closures.
+     */
+    static void queued(long delta){
+      instance().queueDepth.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    /*! \brief Returns the recent 99th percentile event latency, in
+     *         milliseconds.
+     */
+    static int p99(){
+      CDWAdmission& a = instance();
+      std::lock_guard<std::mutex> lock(a.mutex);
+      Clock::time_point now = Clock::now();
+      if(now - a.computed < std::chrono::milliseconds(250))
+        return a.p99Value;
+      a.computed = now;
+
+      std::size_t n = std::min<std::size_t>(a.next.load(std::memory_order_relaxed), (std::size_t)Samples);
+      Clock::rep oldest = (now - std::chrono::seconds(Window)).time_since_epoch().count();
+      std::vector<std::uint32_t> sorted;
+      sorted.reserve(n);
+      for(std::size_t i = 0; i < n; ++i)
+        if(a.finished[i].load(std::memory_order_relaxed) >= oldest)
+          sorted.push_back(a.latencies[i].load(std::memory_order_relaxed));
+      if(sorted.empty())
+        return a.p99Value = 0;
+      std::size_t rank = (sorted.size() * 99) / 100;
+      std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+      return a.p99Value = (int)sorted[rank];
+    }
+
+    static std::size_t samples(){
+      return Samples;
+    }
+
+    static CDWAdmissionStats statistics(){
+      CDWAdmission& a = instance();
+      CDWAdmissionStats stats;
+      stats.inFlight = a.inFlight.load(std::memory_order_relaxed);
+      stats.queueDepth = a.queueDepth.load(std::memory_order_relaxed);
+      stats.p99 = p99();
+      stats.maxInFlight = a.maxInFlight.load(std::memory_order_relaxed);
+      stats.maxQueueDepth = a.maxQueueDepth.load(std::memory_order_relaxed);
+      stats.maxP99 = a.maxP99.load(std::memory_order_relaxed);
+      stats.admitted = a.admittedCount.load(std::memory_order_relaxed);
+      stats.rejected = a.rejectedCount.load(std::memory_order_relaxed);
+      return stats;
+    }
+
+  private:
+    enum { Samples = 1024, Window = 10 };
+
+    std::atomic<int> inFlight;
+    std::atomic<long> queueDepth;
+    std::atomic<int> maxInFlight;
+    std::atomic<long> maxQueueDepth;
+    std::atomic<int> maxP99;
+    std::atomic<std::uint64_t> admittedCount;
+    std::atomic<std::uint64_t> rejectedCount;
+    std::atomic<std::size_t> next;
+    std::atomic<std::uint32_t> latencies[Samples];
+    std::atomic<Clock::rep> finished[Samples];
+
+    std::mutex mutex;
+    std::string busyMessageValue;
+    Clock::time_point computed;
+    int p99Value;
+
+    CDWAdmission()
+      : inFlight(0), queueDepth(0), maxInFlight(0), maxQueueDepth(0), maxP99(0),
+        admittedCount(0), rejectedCount(0), next(0),
+        busyMessageValue("The server is busy, please try again in a moment."),
+        p99Value(0)
+    {
+      for(std::size_t i = 0; i < Samples; ++i){
+        latencies[i].store(0, std::memory_order_relaxed);
+        finished[i].store(0, std::memory_order_relaxed);
+      }
+    }
+
+    static CDWAdmission& instance(){
+      static CDWAdmission admission;
+      return admission;
+    }
+  };
+
+  /*! \brief The application served to sessions that were not admitted.
+   *
+   * It renders CDWAdmission::busyMessage() and quits, so the session is
+   * released right after the response. Its CDWApplication wrapper does not
+   * register the session: it has no handle, directory entry or executor.
+   */
+  class CDWBusyApplication : public WApplication{
+  public:
+    CDWBusyApplication(const WEnvironment& environment)
+      : WApplication(environment), wrapper(0)
+    {
+      setTitle(WString::fromUTF8(CDWAdmission::busyMessage()));
+      root()->addWidget(new WText(WString::fromUTF8(CDWAdmission::busyMessage()), PlainText));
+      quit();
+    }
+
+    virtual ~CDWBusyApplication();
+
+    CDWApplication* wrapper;
+  };
+}
+
+#endif /* CDWADMISSION_H_ */
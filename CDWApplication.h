@@ -5,15 +5,79 @@
  *      Author: Thomas Weyn
  */
 
+#ifndef CDWAPPLICATION_H_
+#define CDWAPPLICATION_H_
+
 #include <Wt/WApplication>
 #include "CDWObject.h"
+#include "CDWApplicationRegistry.h"
+#include "CDWSessionDirectory.h"
+#include "CDWSessionExecutor.h"
+#include "CDWPushThrottle.h"
+#include "CDWContinuation.h"
+#include "CDWCompletion.h"
+#include "CDWDeadline.h"
+#include "CDWAdmission.h"
+#include "CDWRateLimit.h"
+#include "CDWScriptBuffer.h"
+#include "CDWJavaScriptBundle.h"
+#include "CDWSharedStyleSheet.h"
+#include "CDWRouter.h"
+#include "CDWUrlCache.h"
+#include "CDWWidgetTemplate.h"
+#include "CDWTemplateReader.h"
+#include "CDWStaticFragment.h"
+#include "CDWRecyclePool.h"
+#include "CDWString.h"
+#include "CDWToolTipLoader.h"
 
 namespace Wt {
   class CDWApplication : public CDWObject{
   public:
-    static CDWApplication* instance = nullptr;
+    CDWApplication(WApplication* object = 0)
+      : CDWObject(object), scriptFlusherValue(0), javaScriptBatching(true),
+        javaScriptBundleUsed(false), routerValue(0), routeHandler(0), routeUserData(0),
+        recyclePoolValue(0), toolTipLoaderValue(0) {
+      routeMatchValue.route = -1;
+      routeMatchValue.count = 0;
+      if(CDWBusyApplication* busy = dynamic_cast<CDWBusyApplication*>(object)){
+        /* A rejected session only renders the busy page. */
+        busy->wrapper = this;
+        sessionIdValue = object->sessionId();
+      } else if(object){
+        CDWApplicationRegistry::add(object, this);
+        sessionIdValue = object->sessionId();
+        sessionHandle = std::make_shared<CDWSessionHandle>(this, sessionIdValue);
+        CDWSessionDirectory::add(sessionHandle);
+        executorValue = std::make_shared<CDWSessionExecutor>(sessionIdValue);
+        executorValue->setUpdateFunction(&CDWApplication::triggerCurrentUpdate);
+      }
+    }
+
+    virtual ~CDWApplication(){
+      if(sessionHandle)
+        CDWSessionDirectory::remove(sessionHandle);
+      if(executorValue)
+        executorValue->close();
+      if(CDWBusyApplication* busy = dynamic_cast<CDWBusyApplication*>(getObject()))
+        busy->wrapper = 0;
+      else if(wobject)
+        CDWApplicationRegistry::remove(getObject());
+    }
+
+    /*! \brief Looks up a live application by session id.
+     *
+     * This may be called from any thread, see CDWSessionDirectory.
+     */
+    static std::shared_ptr<CDWSessionHandle> findSession(const char* sessionId){
+      return CDWSessionDirectory::find(sessionId);
+    }
 
-    CDWApplication(WApplication* object = 0): CDWObject(object) {}
+    /*! \brief Returns the directory handle of this application.
+     */
+    std::shared_ptr<CDWSessionHandle> handle() const {
+      return sessionHandle;
+    }
 
     WApplication* getObject() const {
       return static_cast<WApplication*>(wobject);
@@ -62,6 +126,64 @@ namespace Wt {
       return getObject()->root();
     }
 
+    /*! \brief Creates the widgets recorded in a template.
+     *
+     * The widgets are added to \p parent, or to root() when \p parent is
+     * \c 0; \p widgets receives the widget of every template node.
+     *
+     * \sa CDWWidgetTemplate
+     */
+    void instantiate(const CDWWidgetTemplate& widgetTemplate, std::vector<WWidget*>& widgets,
+                     WContainerWidget* parent = 0, CDWTemplateListener listener = 0,
+                     void* userData = 0){
+      widgetTemplate.instantiate(parent ? parent : getObject()->root(), widgets, listener, userData);
+    }
+
+    /*! \brief Builds a widget tree from a description, in one call.
+     *
+     * \p data is a description in the format of CDWTemplateReader. The
+     * widgets are created under \p parent, or root() when \p parent is
+     * \c 0, and \p widgets receives the handle table: the widget of every
+     * described node, in order. Bound signals call \p listener with their
+     * listener id.
+     *
+     * Views built repeatedly are better read once into a
+     * CDWWidgetTemplate and instantiated.
+     */
+    void build(const char* data, size_t len, std::vector<WWidget*>& widgets,
+               WContainerWidget* parent = 0, CDWTemplateListener listener = 0, void* userData = 0){
+      CDWWidgetTemplate description;
+      CDWTemplateReader::read(data, len, description);
+      instantiate(description, widgets, parent, listener, userData);
+    }
+
+    /*! \brief Adds a static fragment.
+     *
+     * The fragment is added to \p parent, or to root() when \p parent is
+     * \c 0, as a single widget showing HTML rendered once for all
+     * sessions.
+     *
+     * \sa CDWStaticFragment
+     */
+    WText* addStaticFragment(const char* id, CDWFragmentBuilder builder, void* userData = 0,
+                             WContainerWidget* parent = 0){
+      WText* fragment = CDWStaticFragment::create(id, builder, userData);
+      (parent ? parent : getObject()->root())->addWidget(fragment);
+      return fragment;
+    }
+
+    /*! \brief Returns the widget recycling pool of the session.
+     *
+     * The pool is created on first use and deleted with the application.
+     *
+     * \sa CDWRecyclePool
+     */
+    CDWRecyclePool& recyclePool(){
+      if(!recyclePoolValue)
+        recyclePoolValue = new CDWRecyclePool(getObject());
+      return *recyclePoolValue;
+    }
+
     /*! \brief Finds a widget by name.
      *
      * This finds a widget in the application's widget hierarchy. It
@@ -124,6 +246,17 @@ namespace Wt {
       getObject()->useStyleSheet(link, condition, media);
     }
 
+    /*! \brief Links a style sheet shared by all sessions.
+     *
+     * The rules are not copied into the session: only a link to the
+     * published, cacheable style sheet is rendered.
+     *
+     * \sa CDWSharedStyleSheet
+     */
+    virtual void useStyleSheet(const CDWSharedStyleSheet& styleSheet, const char* media = "all"){
+      getObject()->useStyleSheet(WLink(styleSheet.url()), media);
+    }
+
     /*! \brief Adds an external stylesheet.
      *
      * Widgets may allow configuration of their look and feel through
@@ -269,6 +402,9 @@ namespace Wt {
     virtual void setTitle(const WString& title){
       getObject()->setTitle(title);
     }
+    virtual void setTitle(const char* utf8, size_t len){
+      getObject()->setTitle(utf8String(utf8, len));
+    }
 
     /*! \brief Returns the window title.
      *
@@ -286,6 +422,26 @@ namespace Wt {
       return getObject()->closeMessage();
     }
 
+    /*! \brief Sets the provider for deferred tooltips.
+     *
+     * The provider resolves the keys set with
+     * CDWAbstractArea::setDeferredToolTip() to tooltip texts. It is only
+     * called for keys the user actually hovered, in batches.
+     */
+    virtual void setToolTipProvider(CDWToolTipProvider provider, void* userData = 0){
+      toolTipLoader()->setProvider(provider, userData);
+    }
+
+    /*! \brief Returns the loader of deferred tooltips of the session.
+     *
+     * The loader is created on first use and deleted with the application.
+     */
+    CDWToolTipLoader* toolTipLoader(){
+      if(!toolTipLoaderValue)
+        toolTipLoaderValue = new CDWToolTipLoader(getObject());
+      return toolTipLoaderValue;
+    }
+
     /*! \brief Returns the resource object that provides localized strings.
      *
      * \if cpp
@@ -440,7 +596,7 @@ namespace Wt {
      * \sa bookmarkUrl()
      */
     virtual const char* url(const char* internalPath = "") const{
-      return getObject()->url(internalPath).c_str();
+      return cachedUrl(CDWUrlCache::SessionUrl, internalPath);
     }
 
     /*! \brief Makes an absolute URL.
@@ -460,7 +616,7 @@ namespace Wt {
      * application cannot be guessed correctly by the application.
      */
     virtual const char* makeAbsoluteUrl(const char* url) const{
-      return getObject()->makeAbsoluteUrl(url).c_str();
+      return cachedUrl(CDWUrlCache::AbsoluteUrl, url);
     }
 
     /*! \brief "Resolves" a relative URL taking into account internal paths.
@@ -491,7 +647,19 @@ namespace Wt {
      * a WTemplate.
      */
     virtual const char* resolveRelativeUrl(const char* url) const{
-      return getObject()->resolveRelativeUrl(url).c_str();
+      return cachedUrl(CDWUrlCache::ResolvedUrl, url);
+    }
+
+    /*! \brief Returns the statistics of the URL cache.
+     *
+     * url(), bookmarkUrl(), makeAbsoluteUrl() and resolveRelativeUrl() are
+     * memoized per session, see CDWUrlCache. The returned strings stay
+     * valid until the cache was invalidated twice since, by a change of
+     * the session id, the deployment path or the URL rewriting mode, or
+     * by filling up.
+     */
+    const CDWUrlCacheStats& urlCacheStatistics() const{
+      return urlCache.statistics();
     }
 
       /*! \brief Returns a bookmarkable URL for the current internal path.
@@ -505,7 +673,7 @@ namespace Wt {
        * \sa url(), bookmarkUrl(const char*) const
        */
       virtual const char* bookmarkUrl() const{
-        return getObject()->bookmarkUrl().c_str();
+        return cachedUrl(CDWUrlCache::BookmarkUrl, internalPath());
       }
 
       /*! \brief Returns a bookmarkable URL for a given internal path.
@@ -550,7 +718,7 @@ namespace Wt {
        * \endif
        */
       virtual const char* bookmarkUrl(const char* internalPath) const{
-        return getObject()->bookmarkUrl(internalPath).c_str();
+        return cachedUrl(CDWUrlCache::BookmarkUrl, internalPath);
       }
 
       /*! \brief Changes the internal path.
@@ -690,7 +858,8 @@ namespace Wt {
        * \endif
        */
       virtual const char* internalPath() const{
-        return getObject()->internalPath().c_str();
+        internalPathValue = getObject()->internalPath();
+        return internalPathValue.c_str();
       }
 
       /*! \brief Returns a part of the current internal path.
@@ -715,11 +884,13 @@ namespace Wt {
        * \endif
        */
       virtual const char* internalPathNextPart(const char* path) const{
-        return getObject()->internalPathNextPart(path).c_str();
+        internalPathPartValue = getObject()->internalPathNextPart(path);
+        return internalPathPartValue.c_str();
       }
 
       virtual const char* internalSubPath(const char* path) const{
-        return getObject()->internalSubPath(path).c_str();
+        internalSubPathValue = getObject()->internalSubPath(path);
+        return internalSubPathValue.c_str();
       }
 
       /*! \brief Checks if the internal path matches a given path.
@@ -763,6 +934,36 @@ namespace Wt {
       //FIXME: implement
       //Signal<const char*>& internalPathChanged();
 
+      /*! \brief Dispatches internal paths through a router.
+       *
+       * The current internal path is routed immediately, and every new
+       * one when internalPathChanged() is emitted: \p handler is called
+       * with the match, whose route is -1 when no route matched. The
+       * parameter spans point into the path and are only valid during the
+       * call. The \p router must outlive the application.
+       *
+       * \sa CDWRouter
+       */
+      void setRouter(const CDWRouter& router, CDWRouteHandler handler, void* userData = 0){
+        bool connect = !routerValue;
+        routerValue = &router;
+        routeHandler = handler;
+        routeUserData = userData;
+        if(connect)
+          getObject()->internalPathChanged().connect([this](const std::string& path){
+            route(path);
+          });
+        route(getObject()->internalPath());
+      }
+
+      /*! \brief Returns the last route match.
+       *
+       * Its parameters are only valid while the internal path is routed.
+       */
+      const CDWRouteMatch& routeMatch() const{
+        return routeMatchValue;
+      }
+
       //FIXME: implement
       //Signal<const char*>& internalPathInvalid() { return internalPathInvalid_; }
 
@@ -867,7 +1068,7 @@ namespace Wt {
        * applications should in no way try to interpret its value.
        */
       virtual const char* sessionId(){
-        return getObject()->sessionId();
+        return sessionIdValue.c_str();
       }
 
       /*! \brief Changes the session id.
@@ -880,6 +1081,7 @@ namespace Wt {
        */
       virtual void changeSessionId(){
         getObject()->changeSessionId();
+        syncSessionId();
       }
 
       virtual WebSession* session() const{
@@ -1033,10 +1235,98 @@ namespace Wt {
        * The update is not immediate, and thus changes that happen after this
        * call will equally be pushed to the client.
        *
+       * When a minimum push interval is set, pushes are coalesced, see
+       * setMinimumPushInterval().
+       *
        * \sa enableUpdates()
        */
       virtual void triggerUpdate(){
-        getObject()->triggerUpdate();
+        switch(pushThrottle.request()){
+        case CDWPushThrottle::PushNow:
+          getObject()->triggerUpdate();
+          break;
+        case CDWPushThrottle::PushSchedule:
+          if(WServer* server = WServer::instance())
+            server->schedule(pushThrottle.delay(), sessionIdValue, [](){
+              if(CDWApplication* app = CDWApplicationRegistry::current())
+                app->scheduledPush();
+            });
+          else
+            scheduledPush();
+          break;
+        case CDWPushThrottle::PushFolded:
+          break;
+        }
+      }
+
+      /*! \brief Propagates the updates of the current session.
+       *
+       * Calls triggerUpdate() on the application of the session whose lock
+       * is held, when it has updates enabled. This is the update function
+       * of closures that run within a session, e.g. posted with
+       * WServer::post().
+       */
+      static void triggerCurrentUpdate(){
+        CDWApplication* app = CDWApplicationRegistry::current();
+        if(app && app->updatesEnabled())
+          app->triggerUpdate();
+      }
+
+      /*! \brief Sets the minimum interval between server pushes.
+       *
+       * Any number of triggerUpdate() calls within \p milliSeconds of the
+       * last push collapse into a single push at the end of the interval,
+       * which carries all changes made in the meantime. An interval of 0
+       * (the default) pushes on every call.
+       *
+       * \sa pushStatistics()
+       */
+      virtual void setMinimumPushInterval(int milliSeconds){
+        pushThrottle.setMinimumInterval(milliSeconds);
+      }
+
+      /*! \brief Returns the minimum interval between server pushes.
+       */
+      virtual int minimumPushInterval() const{
+        return pushThrottle.minimumInterval();
+      }
+
+      /*! \brief Returns how many pushes were requested, sent and coalesced.
+       */
+      virtual const CDWPushStats& pushStatistics() const{
+        return pushThrottle.statistics();
+      }
+
+      /*! \brief Returns the executor that runs closures posted to this
+       *         session.
+       *
+       * Keep the returned pointer to post from other threads, it remains
+       * valid after the session has ended. Sessions served the busy page
+       * (see CDWAdmission) have no executor.
+       *
+       * \sa post()
+       */
+      std::shared_ptr<CDWSessionExecutor> executor() const {
+        return executorValue;
+      }
+
+      /*! \brief Posts a closure to this session.
+       *
+       * May be called from any thread. The closure runs within the session,
+       * batched with other posted closures under a single session lock, and
+       * is followed by a single triggerUpdate() when updates are enabled.
+       *
+       * Returns PostQueueFull when the session's queue is full, and
+       * PostNoSession when the session has no executor. When the session
+       * ends before the closure ran, \p discard is called with \p payload
+       * instead.
+       *
+       * \sa CDWSessionExecutor
+       */
+      CDWPostResult post(CDWPostedFunction function, void* payload, CDWPostedFunction discard = 0){
+        if(!executorValue)
+          return PostNoSession;
+        return executorValue->post(function, payload, discard);
       }
 
       /** @name Invoking JavaScript or including scripts
@@ -1054,10 +1344,23 @@ namespace Wt {
        * In most situations, it's more robust to use
        * WWidget::doJavaScript() however.
        *
+       * With batching enabled (the default), the snippets of a response
+       * are combined into one block and exact duplicates are dropped, see
+       * CDWScriptBuffer.
+       *
        * \sa WWidget::doJavaScript(), declareJavaScriptFunction()
        */
       virtual void doJavaScript(const char* javascript, bool afterLoaded = true){
-        getObject()->doJavaScript(javascript, afterLoaded);
+        if(!javaScriptBatching){
+          getObject()->doJavaScript(javascript, afterLoaded);
+          return;
+        }
+
+        scriptFlusher()->request();
+        if(afterLoaded)
+          scriptBuffer.add(javascript);
+        else if(scriptBuffer.addImmediate(javascript))
+          getObject()->doJavaScript(javascript, false);
       }
 
       /*! \brief Adds JavaScript statements that should be run continuously.
@@ -1070,7 +1373,34 @@ namespace Wt {
        * \sa doJavaScript()
        */
       virtual void addAutoJavaScript(const char* javascript){
-        getObject()->addAutoJavaScript(javascript);
+        if(!javaScriptBatching){
+          getObject()->addAutoJavaScript(javascript);
+          return;
+        }
+
+        if(scriptBuffer.addAuto(javascript))
+          scriptFlusher()->request();
+      }
+
+      /*! \brief Enables batching of doJavaScript() and addAutoJavaScript().
+       *
+       * Disabling it flushes nothing: call it before any JavaScript is
+       * added.
+       */
+      void setJavaScriptBatching(bool enabled){
+        javaScriptBatching = enabled;
+      }
+
+      /*! \brief Enables whitespace minification of batched JavaScript.
+       *
+       * \sa CDWScriptBuffer::setMinify()
+       */
+      void setJavaScriptMinification(bool enabled){
+        scriptBuffer.setMinify(enabled);
+      }
+
+      const CDWScriptStats& javaScriptStatistics() const{
+        return scriptBuffer.statistics();
       }
 
       /*! \brief Declares an application-wide JavaScript function.
@@ -1087,11 +1417,37 @@ namespace Wt {
        * app->doJavaScript(app->javaScriptClass() + ".foo('" + id + "');");
        * \endcode
        * \endif
+       *
+       * When the published CDWJavaScriptBundle declares the same function,
+       * the session loads the (cached) bundle instead.
        */
       virtual void declareJavaScriptFunction(const char* name, const char* function){
+        if(CDWJavaScriptBundle::covers(name, function)){
+          useJavaScriptBundle();
+          return;
+        }
         getObject()->declareJavaScriptFunction(name, function);
       }
 
+      /*! \brief Loads the process-wide JavaScript bundle.
+       *
+       * Requires the published CDWJavaScriptBundle and its libraries, once
+       * per session. Returns \c false when no bundle was published.
+       */
+      bool useJavaScriptBundle(){
+        if(!CDWJavaScriptBundle::isPublished())
+          return false;
+        if(!javaScriptBundleUsed){
+          javaScriptBundleUsed = true;
+          getObject()->require(CDWJavaScriptBundle::url());
+          const std::vector<std::pair<std::string, std::string> >& libraries
+            = CDWJavaScriptBundle::libraries();
+          for(std::size_t i = 0; i < libraries.size(); ++i)
+            getObject()->require(libraries[i].first, libraries[i].second);
+        }
+        return true;
+      }
+
       /*! \brief Loads a JavaScript library.
       *
       * Loads a JavaScript library located at the URL \p url. %Wt keeps
@@ -1188,11 +1544,57 @@ namespace Wt {
       * This requires that at least one additional thread is available to
       * process incoming requests, and is not scalable when working with
       * a fixed size thread pools.
+      *
+      * \sa whenSignal()
       */
       virtual void waitForEvent(){
         getObject()->waitForEvent();
       }
 
+      /*! \brief Resumes a continuation when a signal fires.
+      *
+      * Use this instead of waitForEvent() (or WDialog::exec()) to wait for
+      * user input without blocking a server thread: the call returns
+      * immediately and \p function runs when \p signal fires.
+      *
+      * \sa CDWContinuation
+      */
+      template <class S>
+      CDWContinuation* whenSignal(S& signal, CDWContinuationFunction function, void* userData = 0){
+        return CDWContinuation::when(signal, function, userData);
+      }
+
+      /*! \brief Connects a listener through the session's event budget.
+      *
+      * Events of \p signal are charged to the token bucket of
+      * \p signalClass (see eventBudget()). Events over budget are dropped,
+      * or with OverflowCoalesce, the last of them is delivered as soon as
+      * the bucket allows.
+      *
+      * \code
+      * app->connectLimited(area->mouseMoved(), SignalMouseMove, OverflowCoalesce, &onMove, state);
+      * \endcode
+      */
+      template <class E>
+      CDWRateLimited<E>* connectLimited(EventSignal<E>& signal, CDWSignalClass signalClass,
+                                        CDWOverflowMode mode,
+                                        typename CDWRateLimited<E>::Listener listener,
+                                        void* userData = 0){
+        CDWRateLimited<E>* limited = new CDWRateLimited<E>(getObject(), eventBudgetValue, sessionHandle,
+                                                           signalClass, mode, listener, userData);
+        limited->setUpdateFunction(&CDWApplication::triggerCurrentUpdate);
+        signal.connect(limited, &CDWRateLimited<E>::receive);
+        return limited;
+      }
+
+      /*! \brief Returns the inbound event budget of this session.
+      *
+      * \sa connectLimited()
+      */
+      CDWEventBudget& eventBudget(){
+        return eventBudgetValue;
+      }
+
       /*! \brief Reads a configuration property.
       *
       * Tries to read a configured value for the property
@@ -1379,6 +1781,9 @@ namespace Wt {
       virtual void addMetaHeader(const char* name, const WString& content, const char* lang = ""){
         getObject()->addMetaHeader(name, content, lang);
       }
+      virtual void addMetaHeader(const char* name, const char* utf8, size_t len, const char* lang = ""){
+        getObject()->addMetaHeader(name, utf8String(utf8, len), lang);
+      }
 
       /*! \brief Adds an HTML meta header.
        *
@@ -1411,6 +1816,9 @@ namespace Wt {
       virtual void addMetaHeader(MetaHeaderType type, const char* name, const WString& content, const char* lang = ""){
         getObject()->addMetaHeader(type, name, content, lang);
       }
+      virtual void addMetaHeader(MetaHeaderType type, const char* name, const char* utf8, size_t len, const char* lang = ""){
+        getObject()->addMetaHeader(type, name, utf8String(utf8, len), lang);
+      }
 
       /*! \brief Removes one or all meta headers.
        *
@@ -1495,6 +1903,8 @@ namespace Wt {
        */
       virtual void quit(){
         getObject()->quit();
+        if(sessionHandle)
+          CDWSessionDirectory::remove(sessionHandle);
       }
 
       /*! \brief Quits the application.
@@ -1515,6 +1925,11 @@ namespace Wt {
        */
       void quit(const WString& restartMessage){
         getObject()->quit(restartMessage);
+        if(sessionHandle)
+          CDWSessionDirectory::remove(sessionHandle);
+      }
+      void quit(const char* utf8, size_t len){
+        quit(utf8String(utf8, len));
       }
 
       /*! \brief Returns whether the application has quit.
@@ -1656,6 +2071,9 @@ namespace Wt {
       virtual void setConfirmCloseMessage(const WString& message){
         getObject()->setConfirmCloseMessage(message);
       }
+      virtual void setConfirmCloseMessage(const char* utf8, size_t len){
+        getObject()->setConfirmCloseMessage(utf8String(utf8, len));
+      }
 
       /*! \brief Sets the message for the user when the application was .
        */
@@ -1705,6 +2123,67 @@ namespace Wt {
         getObject()->resumeRendering();
       }
 
+      /*! \brief Starts an asynchronous operation within the current event.
+       *
+       * Rendering of the current response is deferred until the returned
+       * handle completes (CDWCompletion::complete(), from any thread) or
+       * \p timeout milliseconds have passed. \p function then runs within
+       * the session and rendering is resumed, so deferRendering() and
+       * resumeRendering() never need to be paired by hand.
+       *
+       * Several operations may be started within the same event; the
+       * response is rendered when the last of them finished. A \p timeout
+       * of 0 waits indefinitely.
+       */
+      std::shared_ptr<CDWCompletion> beginAsync(CDWCompletionFunction function, void* userData = 0,
+                                                int timeout = 30000){
+        std::shared_ptr<CDWCompletion> completion
+          = std::make_shared<CDWCompletion>(sessionHandle, function, userData);
+        completion->setFinishFunction([](){
+          if(CDWApplication* app = CDWApplicationRegistry::current())
+            app->asyncFinished();
+        });
+        getObject()->deferRendering();
+        completion->startTimer(timeout);
+
+        std::vector<PendingAsync> pending;
+        for(std::size_t i = 0; i < pendingCompletions.size(); ++i){
+          std::shared_ptr<CDWCompletion> c = pendingCompletions[i].completion.lock();
+          if(c && !c->finished())
+            pending.push_back(pendingCompletions[i]);
+        }
+        PendingAsync p = { completion, eventToken };
+        pending.push_back(p);
+        pendingCompletions.swap(pending);
+        return completion;
+      }
+
+      /*! \brief Returns the number of asynchronous operations still pending.
+       *
+       * \sa beginAsync()
+       */
+      int pendingAsync() const{
+        int count = 0;
+        for(std::size_t i = 0; i < pendingCompletions.size(); ++i){
+          std::shared_ptr<CDWCompletion> c = pendingCompletions[i].completion.lock();
+          if(c && !c->finished())
+            ++count;
+        }
+        return count;
+      }
+
+      /*! \brief Returns the cancellation token of the current event.
+       *
+       * The token carries the deadline configured in CDWDeadlines for the
+       * event being handled; pass it on to backend calls so that they can
+       * give up once the response is no longer waited for. Returns \c 0
+       * outside of an event, when no deadline applies to the event, or
+       * when the application was not created with constructWApplication().
+       */
+      std::shared_ptr<CDWCancellationToken> cancellationToken() const{
+        return eventToken;
+      }
+
       /*! \brief Protects a function against deletion of the target object.
        *
        * When posting an event using WServer::post(), it is convenient to
@@ -1764,8 +2243,275 @@ namespace Wt {
       virtual void removeGlobalWidget(WWidget *w){
         getObject()->removeGlobalWidget(w);
       }
+
+    private:
+      /* Keeps the token of a deferred event alive for its deadline. */
+      struct PendingAsync{
+        std::weak_ptr<CDWCompletion> completion;
+        std::shared_ptr<CDWCancellationToken> event;
+      };
+
+      std::string sessionIdValue;
+      CDWPushThrottle pushThrottle;
+      std::shared_ptr<CDWSessionHandle> sessionHandle;
+      std::shared_ptr<CDWSessionExecutor> executorValue;
+      std::vector<PendingAsync> pendingCompletions;
+      std::shared_ptr<CDWCancellationToken> eventToken;
+      CDWEventBudget eventBudgetValue;
+      CDWScriptBuffer scriptBuffer;
+      CDWScriptFlusher* scriptFlusherValue;
+      bool javaScriptBatching;
+      bool javaScriptBundleUsed;
+      mutable std::string internalPathValue;
+      mutable std::string internalPathPartValue;
+      mutable std::string internalSubPathValue;
+      const CDWRouter* routerValue;
+      CDWRouteHandler routeHandler;
+      void* routeUserData;
+      CDWRouteMatch routeMatchValue;
+      mutable CDWUrlCache urlCache;
+      CDWRecyclePool* recyclePoolValue;
+      CDWToolTipLoader* toolTipLoaderValue;
+
+      friend class CDWApplicationImpl;
+      friend class CDWApplicationRegistry;
+      friend class CDWBusyApplication;
+
+      /*
+       * Called when Wt deletes the application before its wrapper: the
+       * session is gone, and the wrapper must not touch or delete it.
+       */
+      void applicationDeleted(){
+        if(sessionHandle)
+          CDWSessionDirectory::remove(sessionHandle);
+        if(executorValue)
+          executorValue->close();
+        toolTipLoaderValue = 0;
+        recyclePoolValue = 0;
+        wobject = 0;
+      }
+
+      /*
+       * Follows the session id of the application, which %Wt may also
+       * change by itself, e.g. when Wt::Auth logs a user in.
+       */
+      void syncSessionId(){
+        const std::string& current = getObject()->sessionId();
+        if(current == sessionIdValue)
+          return;
+        sessionIdValue = current;
+        if(sessionHandle)
+          CDWSessionDirectory::rename(sessionHandle, sessionIdValue);
+        if(executorValue)
+          executorValue->setSessionId(sessionIdValue);
+        /* A deferred push was scheduled for the old id, and would be lost. */
+        if(pushThrottle.isPending())
+          scheduledPush();
+      }
+
+      void scheduledPush(){
+        pushThrottle.scheduledPush();
+        getObject()->triggerUpdate();
+      }
+
+      const char* cachedUrl(CDWUrlCache::Kind kind, const char* argument) const{
+        WApplication* app = getObject();
+        const WEnvironment& env = app->environment();
+        urlCache.validate(sessionIdValue, env.deploymentPath(), env.supportsCookies(), env.ajax());
+        int depth = -1;
+        if(kind != CDWUrlCache::AbsoluteUrl && !env.internalPathUsingFragments())
+          depth = CDWUrlCache::depth(app->internalPath());
+        if(const char* url = urlCache.find(kind, depth, argument))
+          return url;
+
+        switch(kind){
+        case CDWUrlCache::SessionUrl:
+          return urlCache.insert(app->url(argument));
+        case CDWUrlCache::BookmarkUrl:
+          return urlCache.insert(app->bookmarkUrl(argument));
+        case CDWUrlCache::AbsoluteUrl:
+          return urlCache.insert(app->makeAbsoluteUrl(argument));
+        case CDWUrlCache::ResolvedUrl:
+          return urlCache.insert(app->resolveRelativeUrl(argument));
+        }
+        return "";
+      }
+
+      void route(const std::string& path){
+        if(!routerValue)
+          return;
+        routerValue->match(path.data(), path.size(), routeMatchValue);
+        if(routeHandler)
+          routeHandler(routeMatchValue, routeUserData);
+      }
+
+      CDWScriptFlusher* scriptFlusher(){
+        if(!scriptFlusherValue)
+          scriptFlusherValue = new CDWScriptFlusher(scriptBuffer, getObject()->domRoot());
+        return scriptFlusherValue;
+      }
+
+      /* Starts the deadline of an event, returns the enclosing event's token. */
+      std::shared_ptr<CDWCancellationToken> eventStarted(){
+        std::shared_ptr<CDWCancellationToken> outer = eventToken;
+        int budget = CDWDeadlines::enabled() ? CDWDeadlines::budget(getObject()->internalPath()) : 0;
+        if(budget <= 0){
+          eventToken.reset();
+          return outer;
+        }
+
+        eventToken = std::make_shared<CDWCancellationToken>(sessionHandle, budget);
+
+        std::weak_ptr<CDWCancellationToken> token = eventToken;
+        CDWDeadlines::watch(eventToken, [token](){
+          CDWApplication* app = CDWApplicationRegistry::current();
+          return app && app->expireAsync(token.lock());
+        });
+        return outer;
+      }
+
+      /* Ends the handler of an event; rendering may still wait for beginAsync(). */
+      void eventFinished(const std::shared_ptr<CDWCancellationToken>& outer){
+        std::shared_ptr<CDWCancellationToken> token = eventToken;
+        eventToken = outer;
+        if(!token)
+          return;
+
+        bool deferred = false;
+        for(std::size_t i = 0; i < pendingCompletions.size() && !deferred; ++i){
+          std::shared_ptr<CDWCompletion> c = pendingCompletions[i].completion.lock();
+          deferred = c && !c->finished() && pendingCompletions[i].event == token;
+        }
+
+        if(!deferred){
+          token->setState(CDWCancellationToken::Finished);
+          CDWDeadlines::unwatch(token.get());
+        } else if(token->cancelled())
+          expireAsync(token);
+        else
+          token->setState(CDWCancellationToken::Deferred);
+      }
+
+      /*
+       * Runs within the session when an operation finished: a deferred
+       * event whose operations all finished is done with its deadline.
+       */
+      void asyncFinished(){
+        std::vector<PendingAsync> pending;
+        std::vector<std::shared_ptr<CDWCancellationToken> > ended;
+        for(std::size_t i = 0; i < pendingCompletions.size(); ++i){
+          std::shared_ptr<CDWCompletion> c = pendingCompletions[i].completion.lock();
+          if(c && !c->finished())
+            pending.push_back(pendingCompletions[i]);
+          else if(pendingCompletions[i].event)
+            ended.push_back(pendingCompletions[i].event);
+        }
+        pendingCompletions.swap(pending);
+
+        for(std::size_t i = 0; i < ended.size(); ++i){
+          const std::shared_ptr<CDWCancellationToken>& token = ended[i];
+          if(token->state() != CDWCancellationToken::Deferred)
+            continue;
+          bool waiting = false;
+          for(std::size_t j = 0; j < pendingCompletions.size() && !waiting; ++j)
+            waiting = pendingCompletions[j].event == token;
+          if(!waiting){
+            token->setState(CDWCancellationToken::Finished);
+            CDWDeadlines::unwatch(token.get());
+          }
+        }
+      }
+
+      /* Times out the operations started by an event, within the session. */
+      bool expireAsync(const std::shared_ptr<CDWCancellationToken>& token){
+        if(!token)
+          return false;
+        token->setState(CDWCancellationToken::Finished);
+
+        std::vector<std::shared_ptr<CDWCompletion> > expired;
+        for(std::size_t i = 0; i < pendingCompletions.size(); ++i)
+          if(pendingCompletions[i].event == token)
+            if(std::shared_ptr<CDWCompletion> c = pendingCompletions[i].completion.lock())
+              expired.push_back(c);
+
+        bool any = false;
+        for(std::size_t i = 0; i < expired.size(); ++i)
+          any = expired[i]->expire() || any;
+        return any;
+      }
   };
 
+  inline CDWApplicationImpl::~CDWApplicationImpl(){
+    if(wrapper)
+      wrapper->applicationDeleted();
+  }
+
+  inline CDWBusyApplication::~CDWBusyApplication(){
+    if(wrapper)
+      wrapper->applicationDeleted();
+  }
+
+  inline CDWToolTipLoader* CDWToolTipLoader::instance(){
+    if(CDWApplication* wrapper = CDWApplicationRegistry::current())
+      return wrapper->toolTipLoader();
+
+    /* An application without wrapper keeps its loader among its children. */
+    WApplication* app = WApplication::instance();
+    const std::vector<WObject*>& children = app->children();
+    for(std::size_t i = 0; i < children.size(); ++i)
+      if(CDWToolTipLoader* loader = dynamic_cast<CDWToolTipLoader*>(children[i]))
+        return loader;
+    return new CDWToolTipLoader(app);
+  }
+
+  /*
+   * Runs while the application is being destroyed: only its address is
+   * used, no longer its type.
+   */
+  inline CDWApplicationRegistry::Watch::~Watch(){
+    CDWApplicationRegistry& r = registry();
+    CDWApplication* wrapper = 0;
+    {
+      std::lock_guard<std::mutex> lock(r.mutex);
+      std::unordered_map<WApplication*, CDWApplication*>::iterator i = r.wrappers.find(app);
+      if(i != r.wrappers.end()){
+        wrapper = i->second;
+        r.wrappers.erase(i);
+        r.invalidate();
+      }
+    }
+    if(wrapper)
+      wrapper->applicationDeleted();
+  }
+
+  inline void CDWApplicationImpl::notify(const WEvent& e){
+    struct Load{
+      CDWAdmission::Clock::time_point started;
+      ~Load(){
+        CDWAdmission::eventFinished(started);
+      }
+    } load = { CDWAdmission::eventStarted() };
+
+    if(!wrapper){
+      WApplication::notify(e);
+      return;
+    }
+    wrapper->syncSessionId();
+
+    struct Scope{
+      CDWApplicationImpl* app;
+      std::shared_ptr<CDWCancellationToken> outer;
+      ~Scope(){
+        if(app->wrapper){
+          app->wrapper->syncSessionId();
+          app->wrapper->eventFinished(outer);
+        }
+      }
+    } scope = { this, wrapper->eventStarted() };
+
+    WApplication::notify(e);
+  }
+
   /*! \brief Create a %WObject with a given parent object.
    *
    * If the optional parent is specified, the parent object will
@@ -1778,11 +2524,61 @@ namespace Wt {
     return new CDWApplication(wobject);
   }
 
+  /*! \brief Creates a new application instance, subject to admission
+   *         control.
+   *
+   * When CDWAdmission::admit() refuses the session, the returned wrapper
+   * holds a CDWBusyApplication instead.
+   */
   inline CDWApplication* construct(const WEnvironment& environment){
-    return new CDWApplication(new WApplication(environment));
+    if(!CDWAdmission::admit())
+      return new CDWApplication(new CDWBusyApplication(environment));
+    return new CDWApplication(new CDWApplicationImpl(environment));
+  }
+
+  /*! \brief Creates a new application instance.
+   *
+   * The \p environment provides information on the initial request,
+   * user agent, and deployment-related information.
+   *
+   * \sa CDWAdmission
+   */
+  inline CDWApplication* constructWApplication(const WEnvironment& environment){
+    return construct(environment);
   }
 
+  /*! \brief Creates a new application instance with a prepared root.
+   *
+   * The root() is populated from \p rootTemplate, recorded once for all
+   * sessions; \p widgets receives the created widgets, by node index.
+   * Sessions served the busy page (see CDWAdmission) are not populated.
+   */
+  inline CDWApplication* constructWApplication(const WEnvironment& environment,
+                                               const CDWWidgetTemplate& rootTemplate,
+                                               std::vector<WWidget*>& widgets){
+    CDWApplication* app = construct(environment);
+    if(dynamic_cast<CDWApplicationImpl*>(app->getObject()))
+      app->instantiate(rootTemplate, widgets);
+    return app;
+  }
+
+  /*! \brief Returns the current application instance.
+   *
+   * In a multi-threaded server, this returns the wrapper of the session
+   * served by the calling thread (see CDWApplicationRegistry), or \c 0
+   * when the thread is not serving a session.
+   */
   inline CDWApplication* getApplication(){
-    return CDWApplication::instance;
+    return CDWApplicationRegistry::current();
+  }
+
+  /*! \brief Returns the current application instance.
+   *
+   * \sa getApplication()
+   */
+  inline CDWApplication* getCDWApplicationInstance(){
+    return CDWApplicationRegistry::current();
   }
 }
+
+#endif /* CDWAPPLICATION_H_ */
@@ -0,0 +1,163 @@
+/*
+ * CDWApplicationRegistry.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWAPPLICATIONREGISTRY_H_
+#define CDWAPPLICATIONREGISTRY_H_
+
+#include <Wt/WApplication>
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace Wt {
+  class CDWApplication;
+
+  /*! \brief The WApplication created by constructWApplication().
+   *
+   * It knows its wrapper, so that the wrapper of the current session can
+   * be found without a lookup. When %Wt deletes it, on session expiry or
+   * when the browser is closed, the wrapper is unbound from it.
+   */
+  class CDWApplicationImpl : public WApplication{
+  public:
+    CDWApplicationImpl(const WEnvironment& environment)
+      : WApplication(environment), wrapper(0) {}
+
+    virtual ~CDWApplicationImpl();
+
+    CDWApplication* wrapper;
+
+  protected:
+    /*! \brief Brackets every event with its deadline, see CDWDeadlines.
+     */
+    virtual void notify(const WEvent& e);
+  };
+
+  /*! \brief Maps sessions to their CDWApplication wrapper.
+   *
+   * %Wt already keeps the current application in thread-specific storage
+   * (WApplication::instance()), so the wrapper for the session a thread is
+   * serving follows from it: through CDWApplicationImpl::wrapper for
+   * applications created with constructWApplication(), or through a
+   * mutex-guarded table for other applications that were wrapped with
+   * construct(WApplication*). A table entry is dropped when its
+   * application is deleted, by a child object of the application.
+   *
+   * For a CDWApplicationImpl the lookup is a field read, and touches no
+   * shared state. For other applications, current() caches the last
+   * (application, wrapper) pair per thread, validated by a generation
+   * that only changes when the table does.
+   */
+  class CDWApplicationRegistry{
+  public:
+    /*! \brief Returns the wrapper of the current session, or \c 0.
+     */
+    static CDWApplication* current(){
+      WApplication* app = WApplication::instance();
+      if(!app)
+        return 0;
+      if(CDWApplicationImpl* impl = dynamic_cast<CDWApplicationImpl*>(app))
+        return impl->wrapper;
+
+      static thread_local Cache cache = { 0, 0, 0 };
+      unsigned generation = registry().generation.load(std::memory_order_acquire);
+      if(cache.app == app && cache.generation == generation)
+        return cache.wrapper;
+
+      cache.app = app;
+      cache.wrapper = findInTable(app);
+      cache.generation = generation;
+      return cache.wrapper;
+    }
+
+    /*! \brief Returns the wrapper of an application, or \c 0.
+     */
+    static CDWApplication* find(WApplication* app){
+      if(CDWApplicationImpl* impl = dynamic_cast<CDWApplicationImpl*>(app))
+        return impl->wrapper;
+      return findInTable(app);
+    }
+
+    /*! \brief Binds a wrapper to its application.
+     */
+    static void add(WApplication* app, CDWApplication* wrapper){
+      if(CDWApplicationImpl* impl = dynamic_cast<CDWApplicationImpl*>(app))
+        impl->wrapper = wrapper;
+      else {
+        CDWApplicationRegistry& r = registry();
+        bool watched;
+        {
+          std::lock_guard<std::mutex> lock(r.mutex);
+          watched = r.wrappers.count(app) != 0;
+          r.wrappers[app] = wrapper;
+          r.invalidate();
+        }
+        if(!watched)
+          new Watch(app);
+      }
+    }
+
+    /*! \brief Unbinds a wrapper from its application.
+     */
+    static void remove(WApplication* app){
+      if(CDWApplicationImpl* impl = dynamic_cast<CDWApplicationImpl*>(app))
+        impl->wrapper = 0;
+      else {
+        CDWApplicationRegistry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.wrappers.erase(app);
+        r.invalidate();
+      }
+    }
+
+  private:
+    /* Unbinds the wrapper of a table application when it is deleted. */
+    class Watch : public WObject{
+    public:
+      Watch(WApplication* app): WObject(app), app(app) {}
+      virtual ~Watch();
+
+    private:
+      WApplication* app;
+    };
+
+    struct Cache{
+      WApplication* app;
+      CDWApplication* wrapper;
+      unsigned generation;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<WApplication*, CDWApplication*> wrappers;
+    std::atomic<unsigned> generation;
+
+    CDWApplicationRegistry(): generation(0) {}
+
+    static CDWApplicationRegistry& registry(){
+      static CDWApplicationRegistry instance;
+      return instance;
+    }
+
+    static CDWApplication* findInTable(WApplication* app){
+      CDWApplicationRegistry& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      std::unordered_map<WApplication*, CDWApplication*>::const_iterator i = r.wrappers.find(app);
+      return i != r.wrappers.end() ? i->second : 0;
+    }
+
+    /*
+     * Invalidates the per-thread caches of the table, since a new
+     * application may reuse the address of a deleted one.
+     */
+    void invalidate(){
+      generation.fetch_add(1, std::memory_order_release);
+    }
+  };
+
+}
+
+#endif /* CDWAPPLICATIONREGISTRY_H_ */
@@ -0,0 +1,438 @@
+/*
+ * CDWAreaOptimizer.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWAREAOPTIMIZER_H_
+#define CDWAREAOPTIMIZER_H_
+
+#include <Wt/WImage>
+#include <Wt/WAbstractArea>
+#include <Wt/WPolygonArea>
+#include <Wt/WRectArea>
+#include <Wt/WPoint>
+#include "CDWAbstractArea.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace Wt {
+
+  /*! \brief Reduces the size of an image map before it is rendered.
+   *
+   * Auto-generated image maps often consist of many adjacent polygons
+   * that share the same link, tooltip and style, and of polygons with far
+   * more vertices than can be distinguished on screen. apply() rewrites
+   * the wrapped areas of a WImage in two steps:
+   *
+   * - adjacent polygon and rectangle areas with identical attributes
+   *   (link(), target(), toolTip(), toolTipKey(), alternateText(),
+   *   styleClass(), cursor()) that share an edge are merged into a polygon
+   *   area;
+   * - every polygon is simplified with the Douglas-Peucker algorithm,
+   *   dropping vertices that are within tolerance() pixels of the
+   *   simplified outline.
+   *
+   * Areas are only merged within runs of consecutive polygon and
+   * rectangle areas: holes (see WAbstractArea::isHole()), other area
+   * types and areas without a wrapper delimit runs. A merged area takes
+   * the place of the first area of its group, so it moves ahead of the
+   * areas that were between its members; two groups are therefore not
+   * merged when another area between them overlaps their bounding box.
+   * This keeps the area that wins for a given pixel unchanged.
+   *
+   * A wrapper keeps the type of its area, so every merge needs a polygon
+   * area to grow: rectangles are absorbed by adjacent polygons, but two
+   * rectangles are not merged with each other.
+   *
+   * Two areas are adjacent when one has an edge from vertex \c p to \c q
+   * and the other an edge from \c q to \c p. Edges meeting in a T-junction
+   * are not detected.
+   *
+   * \note Merged-away areas are removed from the image but not deleted:
+   *       their wrappers are handed back to the caller, and their signal
+   *       connections no longer fire. Only optimize image maps whose areas
+   *       have no event listeners of their own.
+   */
+  class CDWAreaOptimizer{
+  public:
+    /*! \brief Creates an optimizer.
+     *
+     * The \p tolerance is the maximum distance, in pixels, between a
+     * removed vertex and the simplified outline. A tolerance of 0 disables
+     * simplification.
+     */
+    CDWAreaOptimizer(double tolerance = 1.0, bool mergeAdjacent = true)
+      : tolerance(tolerance), mergeAdjacent(mergeAdjacent), areasRemoved(0), pointsRemoved(0) {}
+
+    /*! \brief Optimizes the areas of an image.
+     *
+     * \p areas are wrappers of areas of \p image, in any order. Wrappers
+     * whose area was merged into another one are moved from \p areas to
+     * \p removed; their areas are no longer part of the image, and the
+     * caller deletes or reuses them.
+     */
+    void apply(WImage* image, std::vector<CDWAbstractArea*>& areas,
+               std::vector<CDWAbstractArea*>& removed){
+      std::unordered_map<WAbstractArea*, CDWAbstractArea*> wrappers;
+      for(std::size_t i = 0; i < areas.size(); ++i)
+        wrappers[areas[i]->getObject()] = areas[i];
+
+      const std::vector<WAbstractArea*> current = image->areas();
+      std::vector<CDWAbstractArea*> ordered(current.size(), 0);
+      for(std::size_t i = 0; i < current.size(); ++i){
+        std::unordered_map<WAbstractArea*, CDWAbstractArea*>::const_iterator w = wrappers.find(current[i]);
+        if(w != wrappers.end() && isCandidate(current[i]))
+          ordered[i] = w->second;
+      }
+
+      std::size_t removedBefore = removed.size();
+      std::size_t begin = 0;
+      while(begin < ordered.size()){
+        std::size_t end = begin;
+        while(end < ordered.size() && ordered[end])
+          ++end;
+        if(end > begin)
+          optimizeRun(image, ordered, begin, end, removed);
+        begin = end + 1;
+      }
+
+      if(removed.size() == removedBefore)
+        return;
+      std::unordered_set<CDWAbstractArea*> gone(removed.begin() + removedBefore, removed.end());
+      std::size_t kept = 0;
+      for(std::size_t i = 0; i < areas.size(); ++i)
+        if(!gone.count(areas[i]))
+          areas[kept++] = areas[i];
+      areas.resize(kept);
+    }
+
+    /*! \brief Returns the number of areas removed by merging.
+     */
+    int removedAreas() const { return areasRemoved; }
+
+    /*! \brief Returns the number of polygon vertices removed.
+     */
+    int removedPoints() const { return pointsRemoved; }
+
+    double tolerance;
+    bool mergeAdjacent;
+
+  private:
+    typedef std::vector<WPoint> Polygon;
+
+    struct Candidate{
+      CDWAbstractArea* wrapper;
+      WAbstractArea* area;
+      Polygon points;
+      std::size_t first; //!< First candidate of the merged group
+      std::size_t last;  //!< Last candidate of the merged group
+      bool polygon;
+      bool alive;
+      bool merged;
+    };
+
+    typedef std::pair<unsigned long long, unsigned long long> EdgeKey;
+
+    struct EdgeHash{
+      std::size_t operator()(const EdgeKey& e) const{
+        return std::hash<unsigned long long>()(e.first * 0x9E3779B97F4A7C15ULL ^ e.second);
+      }
+    };
+
+    /* Directed edge -> (candidate, index of the edge's first vertex) */
+    typedef std::unordered_map<EdgeKey, std::pair<std::size_t, std::size_t>, EdgeHash> EdgeMap;
+
+    int areasRemoved;
+    int pointsRemoved;
+
+    struct Box{
+      int left, top, right, bottom;
+    };
+
+    static Box bounds(const Polygon& p){
+      Box b = { p[0].x(), p[0].y(), p[0].x(), p[0].y() };
+      for(std::size_t k = 1; k < p.size(); ++k){
+        b.left = std::min(b.left, p[k].x());
+        b.top = std::min(b.top, p[k].y());
+        b.right = std::max(b.right, p[k].x());
+        b.bottom = std::max(b.bottom, p[k].y());
+      }
+      return b;
+    }
+
+    /* Boxes that only touch count as overlapping: a shared border pixel has a winner too. */
+    static bool overlaps(const Box& a, const Box& b){
+      return a.left <= b.right && b.left <= a.right && a.top <= b.bottom && b.top <= a.bottom;
+    }
+
+    /* True when an area ordered between groups i and j could lose pixels to their merge. */
+    static bool shadowed(const std::vector<Candidate>& candidates, std::size_t i, std::size_t j){
+      const std::size_t lo = std::min(candidates[i].first, candidates[j].first);
+      const std::size_t hi = std::max(candidates[i].last, candidates[j].last);
+      Box joined = bounds(candidates[i].points), other = bounds(candidates[j].points);
+      joined.left = std::min(joined.left, other.left);
+      joined.top = std::min(joined.top, other.top);
+      joined.right = std::max(joined.right, other.right);
+      joined.bottom = std::max(joined.bottom, other.bottom);
+      for(std::size_t c = 0; c < candidates.size(); ++c){
+        if(c == i || c == j || !candidates[c].alive
+            || candidates[c].last < lo || candidates[c].first > hi)
+          continue;
+        if(overlaps(joined, bounds(candidates[c].points)))
+          return true;
+      }
+      return false;
+    }
+
+    static bool isCandidate(WAbstractArea* area){
+      return !area->isHole()
+          && (dynamic_cast<WPolygonArea*>(area) || dynamic_cast<WRectArea*>(area));
+    }
+
+    static unsigned long long pointKey(const WPoint& p){
+      return ((unsigned long long)(unsigned)p.x() << 32) | (unsigned)p.y();
+    }
+
+    static EdgeKey edgeKey(const WPoint& p, const WPoint& q){
+      return std::make_pair(pointKey(p), pointKey(q));
+    }
+
+    static bool sameAttributes(const CDWAbstractArea* a, const CDWAbstractArea* b){
+      return a->link() == b->link()
+          && a->target() == b->target()
+          && a->toolTip() == b->toolTip()
+          && std::strcmp(a->toolTipKey(), b->toolTipKey()) == 0
+          && a->alternateText() == b->alternateText()
+          && a->styleClass() == b->styleClass()
+          && a->cursor() == b->cursor();
+    }
+
+    static Polygon outline(WAbstractArea* area){
+      if(WRectArea* rect = dynamic_cast<WRectArea*>(area)){
+        Polygon p;
+        p.push_back(WPoint(rect->x(), rect->y()));
+        p.push_back(WPoint(rect->x() + rect->width(), rect->y()));
+        p.push_back(WPoint(rect->x() + rect->width(), rect->y() + rect->height()));
+        p.push_back(WPoint(rect->x(), rect->y() + rect->height()));
+        return p;
+      }
+
+      Polygon p = static_cast<WPolygonArea*>(area)->points();
+      long long twiceArea = 0;
+      for(std::size_t i = 0; i < p.size(); ++i){
+        const WPoint& a = p[i];
+        const WPoint& b = p[(i + 1) % p.size()];
+        twiceArea += (long long)a.x() * b.y() - (long long)b.x() * a.y();
+      }
+      if(twiceArea < 0)
+        std::reverse(p.begin(), p.end());
+      return p;
+    }
+
+    /*
+     * Joins b into a along the edge a[i] -> a[i+1], which is b[j+1] -> b[j]
+     * in b.
+     */
+    static Polygon splice(const Polygon& a, std::size_t i, const Polygon& b, std::size_t j){
+      Polygon result;
+      result.reserve(a.size() + b.size() - 2);
+      result.insert(result.end(), a.begin(), a.begin() + i + 1);
+      for(std::size_t k = 2; k < b.size(); ++k)
+        result.push_back(b[(j + k) % b.size()]);
+      result.insert(result.end(), a.begin() + i + 1, a.end());
+      removeSpikes(result);
+      return result;
+    }
+
+    /*
+     * Removes repeated vertices and back-and-forth spikes, which appear
+     * when the merged polygons shared more than one edge.
+     */
+    static void removeSpikes(Polygon& p){
+      bool changed = true;
+      while(changed && p.size() > 3){
+        changed = false;
+        std::size_t k = 0;
+        while(k < p.size() && p.size() > 3){
+          std::size_t n = p.size();
+          const WPoint& prev = p[(k + n - 1) % n];
+          const WPoint& next = p[(k + 1) % n];
+          if(p[k] == next){
+            p.erase(p.begin() + k);
+            changed = true;
+          } else if(prev == next){
+            p.erase(p.begin() + k);
+            p.erase(p.begin() + (k < p.size() ? k : 0));
+            changed = true;
+          } else
+            ++k;
+        }
+      }
+    }
+
+    static double distance(const WPoint& p, const WPoint& a, const WPoint& b){
+      double dx = b.x() - a.x(), dy = b.y() - a.y();
+      double px = p.x() - a.x(), py = p.y() - a.y();
+      double length2 = dx * dx + dy * dy;
+      if(length2 == 0)
+        return std::sqrt(px * px + py * py);
+      double t = std::max(0.0, std::min(1.0, (px * dx + py * dy) / length2));
+      double ex = px - t * dx, ey = py - t * dy;
+      return std::sqrt(ex * ex + ey * ey);
+    }
+
+    /*
+     * Douglas-Peucker on a closed polygon: the outline is split at vertex 0
+     * and the vertex farthest from it, and both chains are reduced.
+     */
+    static Polygon simplify(const Polygon& p, double tolerance){
+      std::size_t n = p.size();
+      if(n <= 3 || tolerance <= 0)
+        return p;
+
+      std::size_t far = 0;
+      double best = -1;
+      for(std::size_t k = 1; k < n; ++k){
+        double dx = p[k].x() - p[0].x(), dy = p[k].y() - p[0].y();
+        if(dx * dx + dy * dy > best){
+          best = dx * dx + dy * dy;
+          far = k;
+        }
+      }
+
+      std::vector<bool> keep(n, false);
+      keep[0] = keep[far] = true;
+      std::vector<std::pair<std::size_t, std::size_t> > stack;
+      stack.push_back(std::make_pair(std::size_t(0), far));
+      stack.push_back(std::make_pair(far, n));
+      while(!stack.empty()){
+        std::size_t first = stack.back().first, last = stack.back().second;
+        stack.pop_back();
+        std::size_t split = 0;
+        double worst = tolerance;
+        for(std::size_t k = first + 1; k < last; ++k){
+          double d = distance(p[k], p[first], p[last % n]);
+          if(d > worst){
+            worst = d;
+            split = k;
+          }
+        }
+        if(split){
+          keep[split] = true;
+          stack.push_back(std::make_pair(first, split));
+          stack.push_back(std::make_pair(split, last));
+        }
+      }
+
+      Polygon result;
+      for(std::size_t k = 0; k < n; ++k)
+        if(keep[k])
+          result.push_back(p[k]);
+      return result.size() >= 3 ? result : p;
+    }
+
+    void mergeRun(std::vector<Candidate>& candidates){
+      bool merged = true;
+      while(merged){
+        merged = false;
+
+        EdgeMap edges;
+        for(std::size_t i = 0; i < candidates.size(); ++i){
+          if(!candidates[i].alive)
+            continue;
+          const Polygon& p = candidates[i].points;
+          for(std::size_t k = 0; k < p.size(); ++k)
+            edges[edgeKey(p[k], p[(k + 1) % p.size()])] = std::make_pair(i, k);
+        }
+
+        std::vector<bool> touched(candidates.size(), false);
+        for(std::size_t i = 0; i < candidates.size(); ++i){
+          if(!candidates[i].alive || touched[i])
+            continue;
+          const Polygon& p = candidates[i].points;
+          for(std::size_t k = 0; k < p.size(); ++k){
+            EdgeMap::const_iterator e = edges.find(edgeKey(p[(k + 1) % p.size()], p[k]));
+            if(e == edges.end())
+              continue;
+            std::size_t j = e->second.first;
+            if(j == i || !candidates[j].alive || touched[j]
+                || (!candidates[i].polygon && !candidates[j].polygon)
+                || !sameAttributes(candidates[i].wrapper, candidates[j].wrapper)
+                || shadowed(candidates, i, j))
+              continue;
+
+            Polygon joined = splice(p, k, candidates[j].points, e->second.second);
+            std::size_t keep = std::min(i, j), drop = std::max(i, j);
+            if(!candidates[keep].polygon)
+              std::swap(keep, drop);
+            candidates[keep].points.swap(joined);
+            candidates[keep].first = std::min(candidates[keep].first, candidates[drop].first);
+            candidates[keep].last = std::max(candidates[keep].last, candidates[drop].last);
+            candidates[keep].merged = true;
+            candidates[drop].alive = false;
+            touched[i] = touched[j] = true;
+            merged = true;
+            break;
+          }
+        }
+      }
+    }
+
+    void optimizeRun(WImage* image, const std::vector<CDWAbstractArea*>& areas,
+                     std::size_t begin, std::size_t end, std::vector<CDWAbstractArea*>& removed){
+      std::vector<Candidate> candidates(end - begin);
+      for(std::size_t i = begin; i < end; ++i){
+        Candidate& c = candidates[i - begin];
+        c.wrapper = areas[i];
+        c.area = areas[i]->getObject();
+        c.points = outline(c.area);
+        c.first = c.last = i - begin;
+        c.polygon = dynamic_cast<WPolygonArea*>(c.area) != 0;
+        c.alive = true;
+        c.merged = false;
+      }
+
+      if(mergeAdjacent)
+        mergeRun(candidates);
+
+      /* A group kept in a later polygon moves to the place of its first area. */
+      for(std::size_t i = 0; i < candidates.size(); ++i){
+        Candidate& c = candidates[i];
+        if(!c.alive || c.first == i)
+          continue;
+        image->removeArea(c.area);
+        const std::vector<WAbstractArea*> current = image->areas();
+        WAbstractArea* first = candidates[c.first].area;
+        image->insertArea((int)(std::find(current.begin(), current.end(), first) - current.begin()), c.area);
+      }
+
+      for(std::size_t i = 0; i < candidates.size(); ++i){
+        Candidate& c = candidates[i];
+        if(!c.alive){
+          image->removeArea(c.area);
+          removed.push_back(c.wrapper);
+          ++areasRemoved;
+          continue;
+        }
+        if(!c.polygon)
+          continue;
+
+        const std::size_t originalSize = static_cast<WPolygonArea*>(c.area)->points().size();
+        Polygon simplified = simplify(c.points, tolerance);
+        if(!c.merged && simplified.size() == originalSize)
+          continue;
+        pointsRemoved += (int)c.points.size() - (int)simplified.size();
+        static_cast<WPolygonArea*>(c.area)->setPoints(simplified);
+      }
+    }
+  };
+}
+
+#endif /* CDWAREAOPTIMIZER_H_ */
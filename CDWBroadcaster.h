@@ -0,0 +1,171 @@
+/*
+ * CDWBroadcaster.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWBROADCASTER_H_
+#define CDWBROADCASTER_H_
+
+#include <Wt/WServer>
+#include "CDWApplication.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Wt {
+
+  /*! \brief Listener for a broadcast topic.
+   *
+   * It is called from within the subscribed session, with exclusive access
+   * to it. The data is shared between all sessions and only valid during
+   * the call.
+   */
+  typedef void (*CDWTopicListener)(const char* topic, const char* data, size_t len, void* userData);
+
+  /*! \brief Publishes one update to every session subscribed to a topic.
+   *
+   * Sessions subscribe to named topics. publish() copies the data once,
+   * takes one lock to get a snapshot of the subscriber list of the topic,
+   * and posts
+   * one closure per subscribed session with WServer::post(): the server's
+   * thread pool then applies the update to the sessions in parallel, each
+   * under its own session lock, followed by a (coalesced, see
+   * CDWApplication::setMinimumPushInterval()) triggerUpdate().
+   *
+   * Subscriptions of sessions that have ended are dropped automatically.
+   */
+  class CDWBroadcaster{
+  public:
+    /*! \brief Subscribes a session to a topic.
+     *
+     * Returns a subscription id, for unsubscribe().
+     */
+    static int subscribe(CDWApplication* app, const std::string& topic,
+                         CDWTopicListener listener, void* userData = 0){
+      CDWBroadcaster& b = instance();
+      std::lock_guard<std::mutex> lock(b.mutex);
+      Subscriber s;
+      s.id = ++b.lastId;
+      s.session = app->handle();
+      s.listener = listener;
+      s.userData = userData;
+
+      Topic& t = b.topics[topic];
+      t.subscribers.push_back(s);
+      t.snapshot.reset();
+      return s.id;
+    }
+
+    /*! \brief Cancels a subscription.
+     */
+    static void unsubscribe(const std::string& topic, int id){
+      CDWBroadcaster& b = instance();
+      std::lock_guard<std::mutex> lock(b.mutex);
+      b.rebuild(topic, id);
+    }
+
+    /*! \brief Publishes data to all subscribers of a topic.
+     *
+     * May be called from any thread. Returns the number of sessions the
+     * update was posted to.
+     */
+    static std::size_t publish(const std::string& topic, const char* data, size_t len){
+      CDWBroadcaster& b = instance();
+      std::shared_ptr<const List> list;
+      {
+        std::lock_guard<std::mutex> lock(b.mutex);
+        TopicMap::iterator i = b.topics.find(topic);
+        if(i == b.topics.end())
+          return 0;
+        if(!i->second.snapshot)
+          i->second.snapshot = std::make_shared<const List>(i->second.subscribers);
+        list = i->second.snapshot;
+      }
+
+      WServer* server = WServer::instance();
+      if(!server)
+        return 0;
+
+      std::shared_ptr<const std::string> payload = std::make_shared<std::string>(data, len);
+      std::shared_ptr<const std::string> name = std::make_shared<std::string>(topic);
+      std::size_t posted = 0;
+      bool stale = false;
+      for(List::const_iterator s = list->begin(); s != list->end(); ++s){
+        std::shared_ptr<CDWSessionHandle> session = s->session.lock();
+        if(!session || !session->application()){
+          stale = true;
+          continue;
+        }
+
+        CDWTopicListener listener = s->listener;
+        void* userData = s->userData;
+        server->post(session->sessionId(), [name, payload, listener, userData](){
+          listener(name->c_str(), payload->data(), payload->size(), userData);
+          CDWApplication::triggerCurrentUpdate();
+        });
+        ++posted;
+      }
+
+      if(stale){
+        std::lock_guard<std::mutex> lock(b.mutex);
+        b.rebuild(topic, 0);
+      }
+      return posted;
+    }
+
+  private:
+    struct Subscriber{
+      int id;
+      std::weak_ptr<CDWSessionHandle> session;
+      CDWTopicListener listener;
+      void* userData;
+    };
+
+    typedef std::vector<Subscriber> List;
+
+    /* Subscriptions change the list; publish() copies it at most once per change. */
+    struct Topic{
+      List subscribers;
+      std::shared_ptr<const List> snapshot;
+    };
+
+    typedef std::unordered_map<std::string, Topic> TopicMap;
+
+    std::mutex mutex;
+    TopicMap topics;
+    int lastId;
+
+    CDWBroadcaster(): lastId(0) {}
+
+    static CDWBroadcaster& instance(){
+      static CDWBroadcaster broadcaster;
+      return broadcaster;
+    }
+
+    /* Drops subscription `id` and subscriptions of ended sessions. */
+    void rebuild(const std::string& topic, int id){
+      TopicMap::iterator i = topics.find(topic);
+      if(i == topics.end())
+        return;
+      List& subscribers = i->second.subscribers;
+      std::size_t kept = 0;
+      for(std::size_t s = 0; s < subscribers.size(); ++s){
+        std::shared_ptr<CDWSessionHandle> session = subscribers[s].session.lock();
+        if(subscribers[s].id != id && session && session->application())
+          subscribers[kept++] = subscribers[s];
+      }
+      if(kept == 0)
+        topics.erase(i);
+      else if(kept != subscribers.size()){
+        subscribers.resize(kept);
+        i->second.snapshot.reset();
+      }
+    }
+  };
+}
+
+#endif /* CDWBROADCASTER_H_ */
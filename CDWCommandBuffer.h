@@ -0,0 +1,298 @@
+/*
+ * CDWCommandBuffer.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWCOMMANDBUFFER_H_
+#define CDWCOMMANDBUFFER_H_
+
+#include <Wt/WAnchor>
+#include <Wt/WApplication>
+#include <Wt/WImage>
+#include <Wt/WLabel>
+#include <Wt/WLineEdit>
+#include <Wt/WLink>
+#include <Wt/WPushButton>
+#include <Wt/WString>
+#include <Wt/WText>
+#include <Wt/WWidget>
+#include "CDWAbstractArea.h"
+#include "CDWUtf8.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Wt {
+
+  /*! \brief Operations of a CDWCommandBuffer.
+   */
+  enum CDWOpcode {
+    OpSetText,          //!< Text of a text, button, label, anchor or line edit
+    OpSetStyleClass,    //!< Style class of a widget or area
+    OpAddStyleClass,    //!< Adds a style class to a widget or area
+    OpRemoveStyleClass, //!< Removes a style class from a widget or area
+    OpSetToolTip,       //!< Tool tip of a widget or area
+    OpSetLink,          //!< Link of an anchor, button or area, image of an image
+    OpSetHidden,        //!< Hides (value != 0) or shows a widget
+    OpSetDisabled,      //!< Disables (value != 0) or enables a widget
+    OpSetAttribute      //!< Sets attribute \c arg0 of a widget to \c arg1
+  };
+
+  /*! \brief Outcome of a command.
+   */
+  enum CDWCommandResult {
+    CommandOk,         //!< Executed
+    CommandBadHandle,  //!< The handle is out of range or null
+    CommandBadTarget,  //!< The object does not support the operation
+    CommandBadOpcode,  //!< Unknown operation
+    CommandNoSession,  //!< The session could not be locked
+    CommandBadArgument //!< A string argument contains a null character
+  };
+
+  /*! \brief An entry of a handle table mixing widgets and areas.
+   */
+  struct CDWCommandHandle{
+    WWidget* widget;
+    CDWAbstractArea* area;
+
+    CDWCommandHandle(WWidget* widget = 0): widget(widget), area(0) {}
+    CDWCommandHandle(CDWAbstractArea* area): widget(0), area(area) {}
+  };
+
+  /*! \brief A recorded batch of property updates.
+   *
+   * Foreign code appends (handle, opcode, arguments) records and submits
+   * the buffer once: execute() runs all commands under a single session
+   * lock, in one switch loop, and reports the outcome of every command
+   * in results(). Handles are indices into a handle table: widgets, such
+   * as the ones filled in by CDWApplication::build(), CDWAbstractArea
+   * wrappers, or both as CDWCommandHandle entries, so that widgets and
+   * areas are updated under the same lock.
+   *
+   * Commands on areas go through the wrapper, so that tool tips replace
+   * a deferred tool tip and style classes update the wrapper's style
+   * tokens. A bare WAbstractArea is refused with CommandBadTarget.
+   *
+   * String arguments are UTF-8 and copied, null-terminated, into one
+   * contiguous arena when appended; invalid UTF-8 is sanitized, and a
+   * command whose arguments contain a null character fails with
+   * CommandBadArgument. clear() keeps the capacity, so a
+   * buffer that is reused does not allocate once it has grown to its
+   * working size. Executing a command still creates the value the target
+   * keeps, such as the WString of a text, directly from the arena.
+   */
+  class CDWCommandBuffer{
+  public:
+    /*! \brief Appends a command with string arguments.
+     */
+    void append(std::uint32_t handle, CDWOpcode opcode, const char* arg0, size_t len0,
+                const char* arg1 = 0, size_t len1 = 0){
+      Command c;
+      c.handle = handle;
+      c.opcode = opcode;
+      c.value = 0;
+      c.valid = (!len0 || std::memchr(arg0, '\0', len0) == 0) && (!len1 || std::memchr(arg1, '\0', len1) == 0);
+      c.arg0 = (std::uint32_t)arena.size();
+      c.len0 = (std::uint32_t)len0;
+      arena.insert(arena.end(), arg0, arg0 + len0);
+      arena.push_back('\0');
+      c.arg1 = (std::uint32_t)arena.size();
+      c.len1 = (std::uint32_t)len1;
+      if(len1)
+        arena.insert(arena.end(), arg1, arg1 + len1);
+      arena.push_back('\0');
+      commands.push_back(c);
+    }
+
+    /*! \brief Appends a command with an integer argument.
+     */
+    void append(std::uint32_t handle, CDWOpcode opcode, int value){
+      Command c;
+      c.handle = handle;
+      c.opcode = opcode;
+      c.value = value;
+      c.valid = true;
+      c.arg0 = c.len0 = c.arg1 = c.len1 = 0;
+      commands.push_back(c);
+    }
+
+    /*! \brief Removes all commands and results, keeping the capacity.
+     */
+    void clear(){
+      commands.clear();
+      arena.clear();
+      resultList.clear();
+    }
+
+    std::size_t size() const {
+      return commands.size();
+    }
+
+    /*! \brief Executes the commands on the objects of a handle table.
+     *
+     * \p handles holds WWidget, WObject or CDWAbstractArea pointers, or
+     * CDWCommandHandle entries. May be called from any thread: the session of \p app is locked for
+     * the whole batch, and updates are pushed once afterwards when called
+     * from outside the session. Returns the number of commands that
+     * failed; results() holds the outcome of each.
+     */
+    template <class T>
+    std::size_t execute(WApplication* app, const std::vector<T>& handles){
+      resultList.assign(commands.size(), CommandNoSession);
+      if(commands.empty())
+        return 0;
+
+      bool outside = WApplication::instance() != app;
+      WApplication::UpdateLock lock(app);
+      if(!lock)
+        return commands.size();
+
+      std::size_t failed = 0;
+      for(std::size_t i = 0; i < commands.size(); ++i){
+        const Command& c = commands[i];
+        if(c.handle >= handles.size())
+          resultList[i] = CommandBadHandle;
+        else if(!c.valid)
+          resultList[i] = CommandBadArgument;
+        else
+          resultList[i] = run(c, handles[c.handle]);
+        if(resultList[i] != CommandOk)
+          ++failed;
+      }
+
+      if(outside && app->updatesEnabled())
+        app->triggerUpdate();
+      return failed;
+    }
+
+    /*! \brief Returns the outcome of every command of the last execute().
+     */
+    const std::vector<CDWCommandResult>& results() const {
+      return resultList;
+    }
+
+  private:
+    struct Command{
+      std::uint32_t handle;
+      std::uint32_t opcode;
+      std::int32_t value;
+      bool valid;
+      std::uint32_t arg0, len0;
+      std::uint32_t arg1, len1;
+    };
+
+    std::vector<Command> commands;
+    std::vector<char> arena;
+    std::vector<CDWCommandResult> resultList;
+
+    const char* bytes(std::uint32_t offset) const {
+      return arena.data() + offset;
+    }
+
+    /* Builds the WString in place from the null-terminated argument. */
+    WString text(std::uint32_t offset, std::uint32_t len) const {
+      return WString::fromUTF8(bytes(offset), !CDWUtf8::validate(bytes(offset), len));
+    }
+
+    CDWCommandResult run(const Command& c, const CDWCommandHandle& handle){
+      return handle.area ? run(c, handle.area) : run(c, handle.widget);
+    }
+
+    CDWCommandResult run(const Command& c, WObject* target){
+      if(!target)
+        return CommandBadHandle;
+      WWidget* widget = dynamic_cast<WWidget*>(target);
+      return widget ? run(c, widget) : CommandBadTarget;
+    }
+
+    CDWCommandResult run(const Command& c, WWidget* widget){
+      if(!widget)
+        return CommandBadHandle;
+      switch(c.opcode){
+      case OpSetText: {
+        WString s = text(c.arg0, c.len0);
+        if(WText* t = dynamic_cast<WText*>(widget))
+          t->setText(s);
+        else if(WPushButton* b = dynamic_cast<WPushButton*>(widget))
+          b->setText(s);
+        else if(WLabel* l = dynamic_cast<WLabel*>(widget))
+          l->setText(s);
+        else if(WAnchor* a = dynamic_cast<WAnchor*>(widget))
+          a->setText(s);
+        else if(WLineEdit* e = dynamic_cast<WLineEdit*>(widget))
+          e->setText(s);
+        else
+          return CommandBadTarget;
+        return CommandOk;
+      }
+      case OpSetStyleClass:
+        widget->setStyleClass(text(c.arg0, c.len0));
+        return CommandOk;
+      case OpAddStyleClass:
+        widget->addStyleClass(text(c.arg0, c.len0));
+        return CommandOk;
+      case OpRemoveStyleClass:
+        widget->removeStyleClass(text(c.arg0, c.len0));
+        return CommandOk;
+      case OpSetToolTip:
+        widget->setToolTip(text(c.arg0, c.len0));
+        return CommandOk;
+      case OpSetLink: {
+        WLink link(std::string(bytes(c.arg0), c.len0));
+        if(WAnchor* a = dynamic_cast<WAnchor*>(widget))
+          a->setLink(link);
+        else if(WPushButton* b = dynamic_cast<WPushButton*>(widget))
+          b->setLink(link);
+        else if(WImage* i = dynamic_cast<WImage*>(widget))
+          i->setImageLink(link);
+        else
+          return CommandBadTarget;
+        return CommandOk;
+      }
+      case OpSetHidden:
+        widget->setHidden(c.value != 0);
+        return CommandOk;
+      case OpSetDisabled:
+        widget->setDisabled(c.value != 0);
+        return CommandOk;
+      case OpSetAttribute:
+        widget->setAttributeValue(std::string(bytes(c.arg0), c.len0), text(c.arg1, c.len1));
+        return CommandOk;
+      }
+      return CommandBadOpcode;
+    }
+
+    CDWCommandResult run(const Command& c, CDWAbstractArea* area){
+      if(!area)
+        return CommandBadHandle;
+      switch(c.opcode){
+      case OpSetStyleClass:
+        area->setStyleClass(text(c.arg0, c.len0));
+        return CommandOk;
+      case OpAddStyleClass:
+        area->addStyleClass(text(c.arg0, c.len0));
+        return CommandOk;
+      case OpRemoveStyleClass:
+        area->removeStyleClass(text(c.arg0, c.len0));
+        return CommandOk;
+      case OpSetToolTip:
+        area->setToolTip(text(c.arg0, c.len0));
+        return CommandOk;
+      case OpSetLink:
+        area->setLink(WLink(std::string(bytes(c.arg0), c.len0)));
+        return CommandOk;
+      case OpSetText:
+      case OpSetHidden:
+      case OpSetDisabled:
+      case OpSetAttribute:
+        return CommandBadTarget;
+      }
+      return CommandBadOpcode;
+    }
+  };
+}
+
+#endif /* CDWCOMMANDBUFFER_H_ */
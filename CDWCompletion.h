@@ -0,0 +1,128 @@
+/*
+ * CDWCompletion.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWCOMPLETION_H_
+#define CDWCOMPLETION_H_
+
+#include <Wt/WApplication>
+#include <Wt/WServer>
+#include "CDWSessionDirectory.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace Wt {
+
+  /*! \brief Continuation of an asynchronous operation.
+   *
+   * Called from within the session, with \p timedOut set when the
+   * operation did not complete in time.
+   */
+  typedef void (*CDWCompletionFunction)(void* userData, bool timedOut);
+
+  /*! \brief Completion handle of an asynchronous backend call.
+   *
+   * Created by CDWApplication::beginAsync() during an event, which defers
+   * rendering of the event's response until the handle completes. Any
+   * number of handles may be pending, so one event can run several backend
+   * calls in parallel: the response is rendered once all of them
+   * completed or timed out.
+   *
+   * complete() may be called from any thread. The continuation then runs
+   * within the session, after which rendering is resumed for this handle;
+   * a handle completes (or times out) exactly once.
+   */
+  class CDWCompletion : public std::enable_shared_from_this<CDWCompletion>{
+  public:
+    CDWCompletion(const std::shared_ptr<CDWSessionHandle>& session,
+                  CDWCompletionFunction function, void* userData)
+      : session(session), function(function), userData(userData), done(false) {}
+
+    /*! \brief Completes the operation.
+     *
+     * May be called from any thread. Returns \c false when the handle
+     * already completed or timed out.
+     */
+    bool complete(){
+      return post(false);
+    }
+
+    /*! \brief Returns whether the handle completed or timed out.
+     */
+    bool finished() const {
+      return done.load(std::memory_order_acquire);
+    }
+
+    /*! \brief Arms the timeout.
+     *
+     * Called by CDWApplication::beginAsync().
+     */
+    void startTimer(int milliSeconds){
+      std::shared_ptr<CDWSessionHandle> s = session.lock();
+      WServer* server = WServer::instance();
+      if(milliSeconds <= 0 || !s || !server)
+        return;
+      std::shared_ptr<CDWCompletion> self = shared_from_this();
+      server->schedule(milliSeconds, s->sessionId(), [self](){
+        if(!self->done.exchange(true, std::memory_order_acq_rel))
+          self->finish(true);
+      });
+    }
+
+    /*! \brief Sets a function run within the session after the
+     *         continuation.
+     *
+     * Called by CDWApplication::beginAsync(), to learn when the last
+     * operation of an event finished.
+     */
+    void setFinishFunction(const std::function<void ()>& function){
+      finishFunction = function;
+    }
+
+    /*! \brief Times the operation out now.
+     *
+     * Must be called from within the session.
+     */
+    bool expire(){
+      if(done.exchange(true, std::memory_order_acq_rel))
+        return false;
+      finish(true);
+      return true;
+    }
+
+  private:
+    std::weak_ptr<CDWSessionHandle> session;
+    CDWCompletionFunction function;
+    void* userData;
+    std::atomic<bool> done;
+    std::function<void ()> finishFunction;
+
+    bool post(bool timedOut){
+      if(done.exchange(true, std::memory_order_acq_rel))
+        return false;
+      std::shared_ptr<CDWSessionHandle> s = session.lock();
+      WServer* server = WServer::instance();
+      if(s && server){
+        std::shared_ptr<CDWCompletion> self = shared_from_this();
+        server->post(s->sessionId(), [self, timedOut](){ self->finish(timedOut); });
+      }
+      return true;
+    }
+
+    /* Runs within the session. */
+    void finish(bool timedOut){
+      if(function)
+        function(userData, timedOut);
+      if(finishFunction)
+        finishFunction();
+      if(WApplication* app = WApplication::instance())
+        app->resumeRendering();
+    }
+  };
+}
+
+#endif /* CDWCOMPLETION_H_ */
@@ -0,0 +1,103 @@
+/*
+ * CDWContinuation.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWCONTINUATION_H_
+#define CDWCONTINUATION_H_
+
+#include <Wt/WApplication>
+#include <Wt/WSignal>
+
+#include <vector>
+
+namespace Wt {
+
+  /*! \brief Continuation resumed when a signal fires.
+   */
+  typedef void (*CDWContinuationFunction)(void* userData);
+
+  /*! \brief A one-shot continuation waiting for a signal.
+   *
+   * This is the non-blocking counterpart of
+   * WApplication::waitForEvent(): instead of blocking a server thread in a
+   * recursive event loop until, say, a dialog is closed, the foreign code
+   * registers what should happen next and returns. The thread goes back to
+   * the pool; when the signal fires, the continuation runs from within
+   * the event that fired it, and is then disconnected.
+   *
+   * \code
+   * dialog->show();
+   * CDWContinuation::when(dialog->finished(), &onDialogDone, state);
+   * // return from the handler, do not call dialog->exec()
+   * \endcode
+   *
+   * Continuations are owned by the application.
+   */
+  class CDWContinuation : public WObject{
+  public:
+    /*! \brief Resumes \p function the next time \p signal fires.
+     *
+     * \p signal may be any Signal or EventSignal; its arguments are not
+     * passed on.
+     *
+     * The returned continuation is deleted by a later call to when(), once
+     * it has run or was cancelled.
+     */
+    template <class S>
+    static CDWContinuation* when(S& signal, CDWContinuationFunction function, void* userData = 0){
+      WApplication* app = WApplication::instance();
+      collect(app);
+      CDWContinuation* continuation = new CDWContinuation(app, function, userData);
+      continuation->connection = signal.connect(continuation, &CDWContinuation::fire);
+      return continuation;
+    }
+
+    /*! \brief Cancels the continuation if it did not run yet.
+     */
+    void cancel(){
+      if(!done){
+        connection.disconnect();
+        done = true;
+      }
+    }
+
+    /*! \brief Returns whether the continuation still waits for its signal.
+     */
+    bool pending() const {
+      return !done;
+    }
+
+  private:
+    CDWContinuationFunction function;
+    void* userData;
+    Wt::Signals::connection connection;
+    bool done;
+
+    CDWContinuation(WObject* parent, CDWContinuationFunction function, void* userData)
+      : WObject(parent), function(function), userData(userData), done(false) {}
+
+    void fire(){
+      if(done)
+        return;
+      cancel();
+      function(userData);
+    }
+
+    /*
+     * Continuations cannot delete themselves while their signal is being
+     * emitted: finished ones are deleted when the next one is created.
+     */
+    static void collect(WApplication* app){
+      std::vector<WObject*> children = app->children();
+      for(std::size_t i = 0; i < children.size(); ++i){
+        CDWContinuation* c = dynamic_cast<CDWContinuation*>(children[i]);
+        if(c && c->done)
+          delete c;
+      }
+    }
+  };
+}
+
+#endif /* CDWCONTINUATION_H_ */
@@ -0,0 +1,375 @@
+/*
+ * CDWDeadline.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWDEADLINE_H_
+#define CDWDEADLINE_H_
+
+#include <Wt/WServer>
+#include "CDWSessionDirectory.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Wt {
+
+  /*! \brief Callback run when a cancellation token is cancelled.
+   */
+  typedef void (*CDWCancelFunction)(void* userData);
+
+  /*! \brief Time budget and cancellation state of one event.
+   *
+   * Every event handled by a CDWApplication gets a token with the deadline
+   * configured in CDWDeadlines. Handlers poll cancelled() or register
+   * callbacks with onCancel() to stop work that is no longer useful.
+   *
+   * The token is thread-safe, so it can be handed to backend calls running
+   * on other threads.
+   */
+  class CDWCancellationToken{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    /*! \brief Lifecycle of the event owning the token.
+     */
+    enum State {
+      Running,  //!< The event handler is running
+      Deferred, //!< The handler returned, rendering waits for async operations
+      Finished  //!< The response was rendered
+    };
+
+    CDWCancellationToken(const std::shared_ptr<CDWSessionHandle>& session, int budget)
+      : session(session),
+        deadlineValue(budget > 0 ? Clock::now() + std::chrono::milliseconds(budget) : Clock::time_point::max()),
+        cancelledValue(false),
+        stateValue(Running) {}
+
+    /*! \brief Returns whether the event was cancelled or ran past its
+     *         deadline.
+     */
+    bool cancelled() const {
+      return cancelledValue.load(std::memory_order_acquire) || Clock::now() >= deadlineValue;
+    }
+
+    /*! \brief Returns the time left before the deadline, in milliseconds.
+     *
+     * Returns -1 when the event has no deadline.
+     */
+    int remaining() const {
+      if(deadlineValue == Clock::time_point::max())
+        return -1;
+      Clock::duration left = deadlineValue - Clock::now();
+      return std::max(0, (int)std::chrono::duration_cast<std::chrono::milliseconds>(left).count());
+    }
+
+    Clock::time_point deadline() const {
+      return deadlineValue;
+    }
+
+    /*! \brief Registers a callback run on cancellation.
+     *
+     * The callback runs on the thread that cancels the token, usually the
+     * deadline watchdog thread, and must not touch the session. When the
+     * token is already cancelled, it runs immediately.
+     */
+    void onCancel(CDWCancelFunction function, void* userData = 0){
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!cancelledValue.load(std::memory_order_acquire)){
+          callbacks.push_back(std::make_pair(function, userData));
+          return;
+        }
+      }
+      function(userData);
+    }
+
+    /*! \brief Cancels the token, returns \c false if it already was.
+     */
+    bool cancel(){
+      std::vector<std::pair<CDWCancelFunction, void*> > run;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(cancelledValue.exchange(true, std::memory_order_acq_rel))
+          return false;
+        run.swap(callbacks);
+      }
+      for(std::size_t i = 0; i < run.size(); ++i)
+        run[i].first(run[i].second);
+      return true;
+    }
+
+    State state() const {
+      return stateValue.load(std::memory_order_acquire);
+    }
+
+    void setState(State state){
+      stateValue.store(state, std::memory_order_release);
+    }
+
+    std::shared_ptr<CDWSessionHandle> sessionHandle() const {
+      return session.lock();
+    }
+
+  private:
+    std::weak_ptr<CDWSessionHandle> session;
+    Clock::time_point deadlineValue;
+    std::atomic<bool> cancelledValue;
+    std::atomic<State> stateValue;
+    std::mutex mutex;
+    std::vector<std::pair<CDWCancelFunction, void*> > callbacks;
+  };
+
+  /*! \brief Deadline statistics, process-wide.
+   */
+  struct CDWDeadlineStats{
+    std::uint64_t events;   //!< Events that had a deadline
+    std::uint64_t timeouts; //!< Events that ran past their deadline
+  };
+
+  /*! \brief Deadline configuration and watchdog.
+   *
+   * The budget of an event is the one of the longest internal path prefix
+   * configured with setDeadline(const std::string&, int) that matches the
+   * internal path when the event starts, or the default budget.
+   *
+   * When no budget is configured, events get no token and cost nothing.
+   * The budgets are published as immutable snapshots, so that looking up
+   * the budget of an event takes no lock; configure them at startup, as
+   * every change keeps its snapshot until the process exits.
+   *
+   * A watchdog thread tracks the deadlines. When an event passes its
+   * deadline, its token is cancelled and a timeout is counted; when the
+   * handler already returned but rendering waits for asynchronous
+   * operations (CDWApplication::beginAsync()), those operations are timed
+   * out so that the response is rendered.
+   */
+  class CDWDeadlines{
+  public:
+    /*! \brief Called within the session when a deferred event expires.
+     *
+     * Returns whether any pending operation was timed out. Installed by
+     * CDWApplication.
+     */
+    typedef std::function<bool ()> ExpireFunction;
+
+    /*! \brief Sets the default budget of an event, 0 disables deadlines.
+     */
+    static void setDefaultDeadline(int milliSeconds){
+      CDWDeadlines& d = instance();
+      std::lock_guard<std::mutex> lock(d.mutex);
+      Budgets* next = new Budgets(*d.budgets.load(std::memory_order_relaxed));
+      next->defaultBudget = milliSeconds;
+      d.publish(next);
+    }
+
+    /*! \brief Sets the budget for events under an internal path prefix.
+     */
+    static void setDeadline(const std::string& internalPathPrefix, int milliSeconds){
+      CDWDeadlines& d = instance();
+      std::lock_guard<std::mutex> lock(d.mutex);
+      Budgets* next = new Budgets(*d.budgets.load(std::memory_order_relaxed));
+      std::size_t i = 0;
+      while(i < next->paths.size() && next->paths[i].first != internalPathPrefix)
+        ++i;
+      if(i < next->paths.size())
+        next->paths[i].second = milliSeconds;
+      else
+        next->paths.push_back(std::make_pair(internalPathPrefix, milliSeconds));
+      d.publish(next);
+    }
+
+    /*! \brief Returns whether any budget is configured.
+     *
+     * Takes no lock.
+     */
+    static bool enabled(){
+      return instance().budgets.load(std::memory_order_acquire)->enabled;
+    }
+
+    /*! \brief Returns the budget for an event on an internal path.
+     *
+     * Takes no lock.
+     */
+    static int budget(const std::string& internalPath){
+      const Budgets* b = instance().budgets.load(std::memory_order_acquire);
+      int result = b->defaultBudget;
+      std::size_t matched = 0;
+      for(std::size_t i = 0; i < b->paths.size(); ++i){
+        const std::string& prefix = b->paths[i].first;
+        if(prefix.size() >= matched && internalPath.compare(0, prefix.size(), prefix) == 0){
+          matched = prefix.size();
+          result = b->paths[i].second;
+        }
+      }
+      return result;
+    }
+
+    /*! \brief Starts watching a token.
+     */
+    static void watch(const std::shared_ptr<CDWCancellationToken>& token, const ExpireFunction& expire){
+      if(token->deadline() == CDWCancellationToken::Clock::time_point::max())
+        return;
+      CDWDeadlines& d = instance();
+      d.eventCount.fetch_add(1, std::memory_order_relaxed);
+      std::lock_guard<std::mutex> lock(d.mutex);
+      Entry e = { token.get(), token, expire };
+      d.entries.insert(std::make_pair(token->deadline(), e));
+      if(!d.watchdog.joinable())
+        d.watchdog = std::thread(&CDWDeadlines::run, &d);
+      d.wakeUp.notify_one();
+    }
+
+    /*! \brief Stops watching a token, once its event finished.
+     */
+    static void unwatch(const CDWCancellationToken* token){
+      if(token->deadline() == CDWCancellationToken::Clock::time_point::max())
+        return;
+      CDWDeadlines& d = instance();
+      std::lock_guard<std::mutex> lock(d.mutex);
+      std::pair<Entries::iterator, Entries::iterator> range = d.entries.equal_range(token->deadline());
+      for(Entries::iterator i = range.first; i != range.second; ++i)
+        if(i->second.key == token){
+          d.entries.erase(i);
+          return;
+        }
+    }
+
+    /*! \brief Counts a timeout.
+     */
+    static void timedOut(){
+      instance().timeoutCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static CDWDeadlineStats statistics(){
+      CDWDeadlines& d = instance();
+      CDWDeadlineStats stats;
+      stats.events = d.eventCount.load(std::memory_order_relaxed);
+      stats.timeouts = d.timeoutCount.load(std::memory_order_relaxed);
+      return stats;
+    }
+
+  private:
+    struct Entry{
+      const CDWCancellationToken* key;
+      std::weak_ptr<CDWCancellationToken> token;
+      ExpireFunction expire;
+    };
+
+    typedef std::multimap<CDWCancellationToken::Clock::time_point, Entry> Entries;
+
+    /* An immutable snapshot of the configured budgets. */
+    struct Budgets{
+      int defaultBudget;
+      std::vector<std::pair<std::string, int> > paths;
+      bool enabled;
+
+      Budgets(): defaultBudget(0), enabled(false) {}
+    };
+
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    Entries entries;
+    std::thread watchdog;
+    bool stopping;
+    std::atomic<const Budgets*> budgets;
+    std::vector<std::unique_ptr<Budgets> > published;
+    std::atomic<std::uint64_t> eventCount;
+    std::atomic<std::uint64_t> timeoutCount;
+
+    CDWDeadlines(): stopping(false), eventCount(0), timeoutCount(0) {
+      published.push_back(std::unique_ptr<Budgets>(new Budgets()));
+      budgets.store(published.back().get(), std::memory_order_release);
+    }
+
+    ~CDWDeadlines(){
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      wakeUp.notify_one();
+      if(watchdog.joinable())
+        watchdog.join();
+    }
+
+    static CDWDeadlines& instance(){
+      static CDWDeadlines deadlines;
+      return deadlines;
+    }
+
+    /*
+     * Called with the mutex held. Earlier snapshots are kept: readers may
+     * still be using them.
+     */
+    void publish(Budgets* next){
+      next->enabled = next->defaultBudget > 0;
+      for(std::size_t i = 0; i < next->paths.size() && !next->enabled; ++i)
+        next->enabled = next->paths[i].second > 0;
+      published.push_back(std::unique_ptr<Budgets>(next));
+      budgets.store(next, std::memory_order_release);
+    }
+
+    void run(){
+      std::unique_lock<std::mutex> lock(mutex);
+      while(!stopping){
+        if(entries.empty()){
+          wakeUp.wait(lock);
+          continue;
+        }
+        Entries::iterator first = entries.begin();
+        if(CDWCancellationToken::Clock::now() < first->first){
+          wakeUp.wait_until(lock, first->first);
+          continue;
+        }
+        Entry next = first->second;
+        entries.erase(first);
+
+        lock.unlock();
+        expire(next);
+        lock.lock();
+      }
+    }
+
+    void expire(const Entry& entry){
+      std::shared_ptr<CDWCancellationToken> token = entry.token.lock();
+      if(!token)
+        return;
+
+      switch(token->state()){
+      case CDWCancellationToken::Finished:
+        return;
+      case CDWCancellationToken::Running:
+        token->cancel();
+        timedOut();
+        return;
+      case CDWCancellationToken::Deferred:
+        token->cancel();
+        break;
+      }
+
+      std::shared_ptr<CDWSessionHandle> session = token->sessionHandle();
+      WServer* server = WServer::instance();
+      if(session && server){
+        ExpireFunction expire = entry.expire;
+        server->post(session->sessionId(), [expire](){
+          if(expire())
+            CDWDeadlines::timedOut();
+        });
+      }
+    }
+  };
+}
+
+#endif /* CDWDEADLINE_H_ */
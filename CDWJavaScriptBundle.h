@@ -0,0 +1,167 @@
+/*
+ * CDWJavaScriptBundle.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWJAVASCRIPTBUNDLE_H_
+#define CDWJAVASCRIPTBUNDLE_H_
+
+#include <Wt/WException>
+#include <Wt/WServer>
+#include "CDWStaticResource.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace Wt {
+
+  /*! \brief Process-wide JavaScript shared by all sessions.
+   *
+   * Application-wide functions and scripts that every session declares
+   * are registered here once, at startup, and published as a single
+   * CDWStaticResource. Sessions then only reference the bundle by its
+   * fingerprinted URL, which clients cache across sessions.
+   *
+   * \code
+   * CDWJavaScriptBundle::declare("foo", "function(id) { ... }");
+   * CDWJavaScriptBundle::require("/js/plugin.js", "Plugin");
+   * CDWJavaScriptBundle::publish(server, "Wt");
+   * \endcode
+   *
+   * After publish() the bundle is immutable and read without locking:
+   * CDWApplication::declareJavaScriptFunction() then skips functions that
+   * the bundle already declares identically, and loads the bundle instead.
+   */
+  class CDWJavaScriptBundle{
+  public:
+    /*! \brief Declares an application-wide function.
+     *
+     * See WApplication::declareJavaScriptFunction(). Declaring a name again
+     * replaces the function.
+     */
+    static void declare(const std::string& name, const std::string& function){
+      CDWJavaScriptBundle& b = instance();
+      std::lock_guard<std::mutex> lock(b.mutex);
+      b.checkMutable();
+      std::unordered_map<std::string, std::string>::iterator i = b.functions.find(name);
+      if(i == b.functions.end())
+        b.order.push_back(name);
+      b.functions[name] = function;
+    }
+
+    /*! \brief Adds a script to the bundle.
+     *
+     * Identical scripts are only included once.
+     */
+    static void addScript(const std::string& source){
+      CDWJavaScriptBundle& b = instance();
+      std::lock_guard<std::mutex> lock(b.mutex);
+      b.checkMutable();
+      if(b.scriptSeen.insert(source).second)
+        b.scripts.push_back(source);
+    }
+
+    /*! \brief Adds a library every session loads, see
+     *         WApplication::require().
+     */
+    static void require(const std::string& url, const std::string& symbol = ""){
+      CDWJavaScriptBundle& b = instance();
+      std::lock_guard<std::mutex> lock(b.mutex);
+      b.checkMutable();
+      for(std::size_t i = 0; i < b.libraryList.size(); ++i)
+        if(b.libraryList[i].first == url)
+          return;
+      b.libraryList.push_back(std::make_pair(url, symbol));
+    }
+
+    /*! \brief Builds the bundle and adds it to \p server.
+     *
+     * \p javaScriptClass is the WApplication::javaScriptClass() of the
+     * applications using the bundle. Must be called once, before the
+     * server is started.
+     */
+    static void publish(WServer& server, const std::string& javaScriptClass){
+      CDWJavaScriptBundle& b = instance();
+      std::lock_guard<std::mutex> lock(b.mutex);
+      b.checkMutable();
+
+      std::string source;
+      for(std::size_t i = 0; i < b.scripts.size(); ++i){
+        source += b.scripts[i];
+        source += '\n';
+      }
+      for(std::size_t i = 0; i < b.order.size(); ++i){
+        const std::string& name = b.order[i];
+        source += javaScriptClass + "." + name + " = " + b.functions[name] + ";\n";
+      }
+
+      b.resource = new CDWStaticResource(source, "application/javascript", "/cdw/", ".js");
+      b.resource->publish(server);
+      b.published.store(true, std::memory_order_release);
+    }
+
+    /*! \brief Returns whether the bundle was published.
+     */
+    static bool isPublished(){
+      return instance().published.load(std::memory_order_acquire);
+    }
+
+    /*! \brief Returns the URL of the published bundle.
+     */
+    static const std::string& url(){
+      CDWJavaScriptBundle& b = instance();
+      if(!isPublished())
+        throw WException("CDWJavaScriptBundle: not published");
+      return b.resource->path();
+    }
+
+    /*! \brief Returns the libraries every session loads.
+     *
+     * Valid after publish().
+     */
+    static const std::vector<std::pair<std::string, std::string> >& libraries(){
+      return instance().libraryList;
+    }
+
+    /*! \brief Returns whether the published bundle declares \p name as
+     *         \p function.
+     */
+    static bool covers(const char* name, const char* function){
+      if(!isPublished())
+        return false;
+      CDWJavaScriptBundle& b = instance();
+      std::unordered_map<std::string, std::string>::const_iterator i = b.functions.find(name);
+      return i != b.functions.end() && i->second == function;
+    }
+
+  private:
+    std::mutex mutex;
+    std::atomic<bool> published;
+    std::vector<std::string> order;
+    std::unordered_map<std::string, std::string> functions;
+    std::vector<std::string> scripts;
+    std::unordered_set<std::string> scriptSeen;
+    std::vector<std::pair<std::string, std::string> > libraryList;
+    CDWStaticResource* resource;
+
+    CDWJavaScriptBundle(): published(false), resource(0) {}
+
+    static CDWJavaScriptBundle& instance(){
+      static CDWJavaScriptBundle bundle;
+      return bundle;
+    }
+
+    void checkMutable(){
+      if(published.load(std::memory_order_acquire))
+        throw WException("CDWJavaScriptBundle: already published");
+    }
+  };
+}
+
+#endif /* CDWJAVASCRIPTBUNDLE_H_ */
@@ -5,6 +5,9 @@
  *      Author: thomas
  */
 
+#ifndef CDWOBJECT_H_
+#define CDWOBJECT_H_
+
 #include <Wt/WObject>
 
 namespace Wt {
@@ -142,3 +145,4 @@ namespace Wt {
   }
 };
 
+#endif /* CDWOBJECT_H_ */
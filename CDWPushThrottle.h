@@ -0,0 +1,116 @@
+/*
+ * CDWPushThrottle.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWPUSHTHROTTLE_H_
+#define CDWPUSHTHROTTLE_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace Wt {
+
+  /*! \brief Push statistics of a session.
+   */
+  struct CDWPushStats{
+    std::uint64_t requested; //!< triggerUpdate() calls
+    std::uint64_t pushed;    //!< Pushes actually sent
+    std::uint64_t coalesced; //!< Calls folded into another push
+  };
+
+  /*! \brief Coalesces server push requests of a session.
+   *
+   * With a minimum interval set, at most one push is sent per interval:
+   * the first request after a quiet interval pushes immediately, later
+   * requests within the interval are folded into one deferred push at the
+   * end of the interval. Since %Wt accumulates all DOM changes until the
+   * next push, that push carries the net result of every folded request.
+   *
+   * The throttle only decides; CDWApplication::triggerUpdate() performs
+   * and schedules the pushes. It is used from within the session only.
+   */
+  class CDWPushThrottle{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    /*! \brief What to do with a push request.
+     */
+    enum Decision {
+      PushNow,      //!< Push immediately
+      PushSchedule, //!< Schedule a deferred push after delay()
+      PushFolded    //!< A deferred push is already scheduled
+    };
+
+    CDWPushThrottle(): interval(0), pending(false) {
+      stats.requested = stats.pushed = stats.coalesced = 0;
+    }
+
+    /*! \brief Sets the minimum interval between pushes.
+     *
+     * An interval of 0 (the default) disables coalescing.
+     */
+    void setMinimumInterval(int milliSeconds){
+      interval = std::chrono::milliseconds(milliSeconds);
+    }
+
+    int minimumInterval() const {
+      return (int)interval.count();
+    }
+
+    /*! \brief Registers a push request.
+     */
+    Decision request(){
+      ++stats.requested;
+      if(pending){
+        ++stats.coalesced;
+        return PushFolded;
+      }
+
+      Clock::time_point now = Clock::now();
+      if(interval.count() == 0 || now - lastPush >= interval){
+        lastPush = now;
+        ++stats.pushed;
+        return PushNow;
+      }
+
+      pending = true;
+      return PushSchedule;
+    }
+
+    /*! \brief Returns the delay for a scheduled push, in milliseconds.
+     */
+    int delay() const {
+      Clock::duration left = lastPush + interval - Clock::now();
+      return std::max(0, (int)std::chrono::duration_cast<std::chrono::milliseconds>(left).count());
+    }
+
+    /*! \brief Returns whether a deferred push is scheduled.
+     */
+    bool isPending() const {
+      return pending;
+    }
+
+    /*! \brief Registers that the scheduled push is being sent.
+     */
+    void scheduledPush(){
+      pending = false;
+      lastPush = Clock::now();
+      ++stats.pushed;
+    }
+
+    const CDWPushStats& statistics() const {
+      return stats;
+    }
+
+  private:
+    std::chrono::milliseconds interval;
+    Clock::time_point lastPush;
+    bool pending;
+    CDWPushStats stats;
+  };
+}
+
+#endif /* CDWPUSHTHROTTLE_H_ */
@@ -0,0 +1,311 @@
+/*
+ * CDWRateLimit.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWRATELIMIT_H_
+#define CDWRATELIMIT_H_
+
+#include <Wt/WObject>
+#include <Wt/WServer>
+#include <Wt/WSignal>
+#include "CDWSessionDirectory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Wt {
+
+  /*! \brief Classes of inbound signals, each with its own budget.
+   */
+  enum CDWSignalClass {
+    SignalKey,       //!< Keyboard events
+    SignalMouse,     //!< Clicks, mouse buttons and the wheel
+    SignalMouseMove, //!< Mouse moves, drags and hovering
+    SignalOther,     //!< Everything else
+    SignalClassCount
+  };
+
+  /*! \brief What happens to events over budget.
+   */
+  enum CDWOverflowMode {
+    OverflowDrop,    //!< Excess events are dropped
+    OverflowCoalesce //!< Only the last excess event is delivered, when the budget allows
+  };
+
+  /*! \brief Counters of one signal class.
+   */
+  struct CDWEventBudgetStats{
+    std::uint64_t accepted;  //!< Events delivered
+    std::uint64_t dropped;   //!< Events dropped
+    std::uint64_t coalesced; //!< Events replaced by a later one
+  };
+
+  /*! \brief A token bucket: \p rate tokens per second, at most \p burst.
+   *
+   * A \p burst below 1 is raised to 1, otherwise the bucket could never
+   * hold a whole token and would refuse every event.
+   */
+  class CDWTokenBucket{
+  public:
+    typedef std::chrono::steady_clock Clock;
+
+    CDWTokenBucket(double rate = 0, double burst = 0)
+      : rate(rate), burst(std::max(burst, 1.0)), tokens(std::max(burst, 1.0)), last(Clock::now()) {}
+
+    /*! \brief Takes a token, returns \c false if none is left.
+     *
+     * A bucket with a rate of 0 is unlimited.
+     */
+    bool take(){
+      if(rate <= 0)
+        return true;
+      refill();
+      if(tokens < 1)
+        return false;
+      tokens -= 1;
+      return true;
+    }
+
+    /*! \brief Returns the time until the next token, in milliseconds.
+     */
+    int wait(){
+      if(rate <= 0)
+        return 0;
+      refill();
+      return tokens >= 1 ? 0 : (int)((1 - tokens) * 1000 / rate) + 1;
+    }
+
+  private:
+    double rate;
+    double burst;
+    double tokens;
+    Clock::time_point last;
+
+    void refill(){
+      Clock::time_point now = Clock::now();
+      double seconds = std::chrono::duration<double>(now - last).count();
+      last = now;
+      tokens = std::min(burst, tokens + seconds * rate);
+    }
+  };
+
+  /*! \brief The inbound event budget of a session.
+   *
+   * One token bucket per CDWSignalClass, shared by every listener of the
+   * session connected with CDWApplication::connectLimited(): a client
+   * firing events faster than its budget only delays or loses its own
+   * events, instead of occupying the server's thread pool.
+   *
+   * New sessions start with the defaults set with setDefaultRate(). The
+   * budget is used from within the session only; the defaults are
+   * thread-safe.
+   */
+  class CDWEventBudget{
+  public:
+    CDWEventBudget(){
+      for(int i = 0; i < SignalClassCount; ++i){
+        double rate, burst;
+        defaultRate((CDWSignalClass)i, rate, burst);
+        buckets[i] = CDWTokenBucket(rate, burst);
+        stats[i].accepted = stats[i].dropped = stats[i].coalesced = 0;
+      }
+    }
+
+    /*! \brief Sets the default budget of a signal class for new sessions.
+     *
+     * A \p rate of 0 events per second means unlimited; a \p burst
+     * below 1 is raised to 1.
+     */
+    static void setDefaultRate(CDWSignalClass signalClass, double rate, double burst){
+      Defaults& d = defaults();
+      std::lock_guard<std::mutex> lock(d.mutex);
+      d.rate[signalClass] = rate;
+      d.burst[signalClass] = std::max(burst, 1.0);
+    }
+
+    /*! \brief Sets the budget of a signal class for this session.
+     */
+    void setRate(CDWSignalClass signalClass, double rate, double burst){
+      buckets[signalClass] = CDWTokenBucket(rate, burst);
+    }
+
+    CDWTokenBucket& bucket(CDWSignalClass signalClass){
+      return buckets[signalClass];
+    }
+
+    CDWEventBudgetStats& statistics(CDWSignalClass signalClass){
+      return stats[signalClass];
+    }
+
+    const CDWEventBudgetStats& statistics(CDWSignalClass signalClass) const {
+      return stats[signalClass];
+    }
+
+    /*! \brief Returns whether any event of this session was dropped or
+     *         coalesced.
+     */
+    bool throttled() const {
+      for(int i = 0; i < SignalClassCount; ++i)
+        if(stats[i].dropped || stats[i].coalesced)
+          return true;
+      return false;
+    }
+
+  private:
+    struct Defaults{
+      std::mutex mutex;
+      double rate[SignalClassCount];
+      double burst[SignalClassCount];
+
+      Defaults(){
+        std::fill(rate, rate + SignalClassCount, 0.0);
+        std::fill(burst, burst + SignalClassCount, 0.0);
+      }
+    };
+
+    CDWTokenBucket buckets[SignalClassCount];
+    CDWEventBudgetStats stats[SignalClassCount];
+
+    static Defaults& defaults(){
+      static Defaults d;
+      return d;
+    }
+
+    static void defaultRate(CDWSignalClass signalClass, double& rate, double& burst){
+      Defaults& d = defaults();
+      std::lock_guard<std::mutex> lock(d.mutex);
+      rate = d.rate[signalClass];
+      burst = d.burst[signalClass];
+    }
+  };
+
+  /*! \brief A listener connected through the session's event budget.
+   *
+   * Created by CDWApplication::connectLimited(), and owned by the
+   * application. Delete it to disconnect.
+   *
+   * A coalesced event delivered later is followed by the update function
+   * (see setUpdateFunction()), so that its changes reach the browser.
+   */
+  template <class E>
+  class CDWRateLimited : public WObject{
+  public:
+    typedef void (*Listener)(const E& event, void* userData);
+
+    CDWRateLimited(WObject* parent, CDWEventBudget& budget,
+                   const std::shared_ptr<CDWSessionHandle>& session,
+                   CDWSignalClass signalClass, CDWOverflowMode mode,
+                   Listener listener, void* userData)
+      : WObject(parent),
+        state(std::make_shared<State>(budget, signalClass, listener, userData)),
+        session(session), mode(mode) {}
+
+    /*! \brief Sets the function pushing changes after a coalesced event.
+     *
+     * CDWApplication::connectLimited() sets it to
+     * CDWApplication::triggerCurrentUpdate(), so that the push throttle
+     * applies. Without one, no update is pushed.
+     */
+    void setUpdateFunction(const std::function<void ()>& function){
+      state->updateFunction = function;
+    }
+
+    /*! \brief Receives an event from the signal.
+     */
+    void receive(const E& event){
+      CDWEventBudgetStats& stats = state->budget.statistics(state->signalClass);
+      if(state->pending){
+        state->latest = event;
+        ++stats.coalesced;
+        return;
+      }
+
+      CDWTokenBucket& bucket = state->budget.bucket(state->signalClass);
+      if(bucket.take()){
+        ++stats.accepted;
+        state->listener(event, state->userData);
+        return;
+      }
+
+      std::shared_ptr<CDWSessionHandle> s = session.lock();
+      WServer* server = WServer::instance();
+      if(mode == OverflowDrop || !s || !server){
+        ++stats.dropped;
+        return;
+      }
+
+      state->pending = true;
+      state->latest = event;
+      scheduleFlush(state, s, server, bucket.wait());
+    }
+
+  private:
+    struct State{
+      CDWEventBudget& budget;
+      CDWSignalClass signalClass;
+      Listener listener;
+      void* userData;
+      bool pending;
+      E latest;
+      std::function<void ()> updateFunction;
+
+      State(CDWEventBudget& budget, CDWSignalClass signalClass, Listener listener, void* userData)
+        : budget(budget), signalClass(signalClass), listener(listener), userData(userData),
+          pending(false) {}
+
+      /* Runs within the session: delivers the coalesced event. */
+      void flush(){
+        if(!pending)
+          return;
+        pending = false;
+        budget.bucket(signalClass).take();
+        ++budget.statistics(signalClass).accepted;
+        listener(latest, userData);
+
+        if(updateFunction)
+          updateFunction();
+      }
+    };
+
+    std::shared_ptr<State> state;
+    std::weak_ptr<CDWSessionHandle> session;
+    CDWOverflowMode mode;
+
+    /*
+     * Schedules the delivery of the coalesced event. When the timer
+     * cannot be delivered, because the session id changed meanwhile, it is
+     * scheduled again on the new id; when the session is gone, the event
+     * is dropped so that later events are not coalesced forever.
+     */
+    static void scheduleFlush(const std::shared_ptr<State>& state,
+                              const std::shared_ptr<CDWSessionHandle>& session,
+                              WServer* server, int delay){
+      std::weak_ptr<State> weak = state;
+      std::weak_ptr<CDWSessionHandle> weakSession = session;
+      std::string id = session->sessionId();
+      server->schedule(delay, id, [weak](){
+        if(std::shared_ptr<State> st = weak.lock())
+          st->flush();
+      }, [weak, weakSession, id](){
+        std::shared_ptr<State> st = weak.lock();
+        if(!st)
+          return;
+        std::shared_ptr<CDWSessionHandle> s = weakSession.lock();
+        WServer* server = WServer::instance();
+        if(s && server && s->sessionId() != id)
+          scheduleFlush(st, s, server, 0);
+        else
+          st->pending = false;
+      });
+    }
+  };
+}
+
+#endif /* CDWRATELIMIT_H_ */
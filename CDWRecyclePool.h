@@ -0,0 +1,176 @@
+/*
+ * CDWRecyclePool.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWRECYCLEPOOL_H_
+#define CDWRECYCLEPOOL_H_
+
+#include <Wt/WContainerWidget>
+#include <Wt/WException>
+#include <Wt/WObject>
+#include <Wt/WWidget>
+
+#include <cstdint>
+#include <vector>
+
+namespace Wt {
+
+  /*! \brief Creates a subtree of a recycled kind.
+   */
+  typedef WWidget* (*CDWRecycleFactory)(void* userData);
+
+  /*! \brief Resets a released subtree before it is kept for reuse.
+   */
+  typedef void (*CDWRecycleReset)(WWidget* widget, void* userData);
+
+  /*! \brief Recycling statistics of a kind.
+   */
+  struct CDWRecycleStats{
+    std::uint64_t reused;    //!< acquire() calls served from the pool
+    std::uint64_t created;   //!< acquire() calls that created a subtree
+    std::uint64_t discarded; //!< release() calls that deleted the subtree
+  };
+
+  /*! \brief Keeps released widget subtrees of a session for reuse.
+   *
+   * Views that are rebuilt often, such as the rows of a list on every page
+   * flip, register the kinds of subtrees they build. Instead of deleting
+   * a subtree and creating a new one, release() detaches it, resets it
+   * and keeps it; acquire() hands it back, so paging becomes mostly
+   * property updates instead of allocations.
+   *
+   * A kind keeps at most its capacity of idle subtrees, and the pool as a
+   * whole at most its byte budget, using the approximate size given for
+   * each kind; beyond that, released subtrees are deleted.
+   *
+   * The pool is owned by its parent, normally the application (see
+   * CDWApplication::recyclePool()), and deletes its idle subtrees with it.
+   */
+  class CDWRecyclePool : public WObject{
+  public:
+    CDWRecyclePool(WObject* parent = 0)
+      : WObject(parent), budget(4 << 20), idleBytes(0) {}
+
+    ~CDWRecyclePool(){
+      for(std::size_t k = 0; k < kinds.size(); ++k)
+        for(std::size_t i = 0; i < kinds[k].idle.size(); ++i)
+          delete kinds[k].idle[i];
+    }
+
+    /*! \brief Registers a kind of subtree, returns its id.
+     *
+     * \p reset may be \c 0. \p capacity is the number of idle subtrees
+     * kept, \p approximateSize their approximate size in bytes.
+     */
+    int registerKind(CDWRecycleFactory factory, CDWRecycleReset reset, void* userData = 0,
+                     std::size_t capacity = 64, std::size_t approximateSize = 2048){
+      Kind k;
+      k.factory = factory;
+      k.reset = reset;
+      k.userData = userData;
+      k.capacity = capacity;
+      k.size = approximateSize;
+      k.stats.reused = k.stats.created = k.stats.discarded = 0;
+      kinds.push_back(k);
+      return (int)kinds.size() - 1;
+    }
+
+    /*! \brief Sets the byte budget of all idle subtrees.
+     */
+    void setBudget(std::size_t bytes){
+      budget = bytes;
+    }
+
+    /*! \brief Returns a subtree of a kind, reused or new.
+     *
+     * The subtree has no parent.
+     */
+    WWidget* acquire(int kind){
+      Kind& k = get(kind);
+      if(k.idle.empty()){
+        ++k.stats.created;
+        return k.factory(k.userData);
+      }
+
+      WWidget* w = k.idle.back();
+      k.idle.pop_back();
+      idleBytes -= k.size;
+      ++k.stats.reused;
+      return w;
+    }
+
+    /*! \brief Gives a subtree of a kind back.
+     *
+     * The subtree is removed from its parent, then reset and kept, or
+     * deleted when the pool is full.
+     *
+     * Only a WContainerWidget parent can give a widget back: other parents,
+     * such as a WTemplate or a layout, keep referring to it. Throws a
+     * WException when \p widget is kept by another parent; remove it from
+     * there first.
+     */
+    void release(int kind, WWidget* widget){
+      Kind& k = get(kind);
+      if(k.idle.size() >= k.capacity || idleBytes + k.size > budget){
+        ++k.stats.discarded;
+        delete widget;
+        return;
+      }
+
+      if(WObject* parent = widget->parent()){
+        WContainerWidget* container = dynamic_cast<WContainerWidget*>(parent);
+        if(!container)
+          throw WException("CDWRecyclePool: widget is not in a container");
+        container->removeWidget(widget);
+      }
+      if(k.reset)
+        k.reset(widget, k.userData);
+      k.idle.push_back(widget);
+      idleBytes += k.size;
+    }
+
+    /*! \brief Deletes the idle subtrees of all kinds.
+     */
+    void trim(){
+      for(std::size_t k = 0; k < kinds.size(); ++k){
+        for(std::size_t i = 0; i < kinds[k].idle.size(); ++i)
+          delete kinds[k].idle[i];
+        kinds[k].idle.clear();
+      }
+      idleBytes = 0;
+    }
+
+    std::size_t idle(int kind) const {
+      return kinds[kind].idle.size();
+    }
+
+    const CDWRecycleStats& statistics(int kind) const {
+      return kinds[kind].stats;
+    }
+
+  private:
+    struct Kind{
+      CDWRecycleFactory factory;
+      CDWRecycleReset reset;
+      void* userData;
+      std::size_t capacity;
+      std::size_t size;
+      std::vector<WWidget*> idle;
+      CDWRecycleStats stats;
+    };
+
+    std::vector<Kind> kinds;
+    std::size_t budget;
+    std::size_t idleBytes;
+
+    Kind& get(int kind){
+      if(kind < 0 || kind >= (int)kinds.size())
+        throw WException("CDWRecyclePool: unknown kind");
+      return kinds[kind];
+    }
+  };
+}
+
+#endif /* CDWRECYCLEPOOL_H_ */
@@ -0,0 +1,257 @@
+/*
+ * CDWRouter.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWROUTER_H_
+#define CDWROUTER_H_
+
+#include <Wt/WException>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Wt {
+
+  /*! \brief A part of the matched internal path.
+   *
+   * Points into the matched path, which must outlive it.
+   */
+  struct CDWPathSpan{
+    const char* data;
+    std::size_t size;
+
+    std::string str() const {
+      return std::string(data, size);
+    }
+  };
+
+  /*! \brief Result of CDWRouter::match().
+   */
+  struct CDWRouteMatch{
+    enum { MaxParameters = 8 };
+
+    int route;                            //!< The route id, -1 when no route matched
+    int count;                            //!< Number of parameters
+    CDWPathSpan params[MaxParameters];    //!< Parameters, in pattern order
+  };
+
+  /*! \brief Called with the route matching a new internal path.
+   */
+  typedef void (*CDWRouteHandler)(const CDWRouteMatch& match, void* userData);
+
+  /*! \brief Compiled internal path router.
+   *
+   * Routes are patterns of '/'-separated segments. A segment is a literal,
+   * a parameter <tt>:name</tt> matching any one segment, or, as the last
+   * segment, a wildcard <tt>*name</tt> matching the rest of the path
+   * (possibly empty):
+   *
+   * \code
+   * static CDWRouter router;
+   * const int Project = router.add("/project/:id");
+   * const int Details = router.add("/project/:id/details");
+   * \endcode
+   *
+   * The routes form a trie of segments, built once, typically at startup;
+   * after that, the router is immutable and may be shared by all sessions.
+   * match() walks the trie in one pass over the path, preferring literals
+   * over parameters over wildcards, and fills a CDWRouteMatch without
+   * allocating. Empty segments (double or trailing slashes) are ignored.
+   *
+   * \sa CDWApplication::setRouter()
+   */
+  class CDWRouter{
+  public:
+    CDWRouter(){
+      nodes.push_back(Node());
+    }
+
+    /*! \brief Adds a route, returns its id.
+     *
+     * Ids are assigned in order, starting at 0. Adding a pattern twice
+     * returns the id of the first.
+     */
+    int add(const std::string& pattern){
+      int node = 0;
+      std::vector<std::string> names;
+      std::size_t pos = 0;
+      while(nextSegment(pattern.data(), pattern.size(), pos)){
+        std::size_t begin = pos;
+        while(pos < pattern.size() && pattern[pos] != '/')
+          ++pos;
+        std::string segment = pattern.substr(begin, pos - begin);
+
+        if(segment[0] == ':'){
+          names.push_back(segment.substr(1));
+          if(nodes[node].param < 0){
+            int child = newNode();
+            nodes[node].param = child;
+          }
+          node = nodes[node].param;
+        } else if(segment[0] == '*'){
+          if(nextSegment(pattern.data(), pattern.size(), pos))
+            throw WException("CDWRouter: wildcard must be the last segment of " + pattern);
+          names.push_back(segment.substr(1));
+          if(nodes[node].wildcard < 0){
+            int child = newNode();
+            nodes[node].wildcard = child;
+          }
+          node = nodes[node].wildcard;
+        } else
+          node = literalChild(node, segment);
+      }
+
+      if(names.size() > CDWRouteMatch::MaxParameters)
+        throw WException("CDWRouter: too many parameters in " + pattern);
+      if(nodes[node].route >= 0)
+        return nodes[node].route;
+
+      nodes[node].route = (int)routes.size();
+      routes.push_back(names);
+      return nodes[node].route;
+    }
+
+    /*! \brief Matches \p path, returns whether a route matched.
+     */
+    bool match(const char* path, std::size_t len, CDWRouteMatch& result) const {
+      result.count = 0;
+      result.route = -1;
+      return matchNode(0, path, len, 0, result);
+    }
+
+    bool match(const char* path, CDWRouteMatch& result) const {
+      return match(path, std::strlen(path), result);
+    }
+
+    /*! \brief Returns the index of parameter \p name of a route, or -1.
+     */
+    int parameterIndex(int route, const char* name) const {
+      const std::vector<std::string>& names = routes[route];
+      for(std::size_t i = 0; i < names.size(); ++i)
+        if(names[i] == name)
+          return (int)i;
+      return -1;
+    }
+
+    /*! \brief Returns parameter \p name of a match, or an empty span.
+     */
+    CDWPathSpan parameter(const CDWRouteMatch& match, const char* name) const {
+      CDWPathSpan none = { "", 0 };
+      if(match.route < 0)
+        return none;
+      int i = parameterIndex(match.route, name);
+      return i >= 0 ? match.params[i] : none;
+    }
+
+    std::size_t size() const {
+      return routes.size();
+    }
+
+  private:
+    struct Node{
+      std::vector<std::pair<std::string, int> > literals; // sorted by segment
+      int param;
+      int wildcard;
+      int route;
+
+      Node(): param(-1), wildcard(-1), route(-1) {}
+    };
+
+    std::vector<Node> nodes;
+    std::vector<std::vector<std::string> > routes;
+
+    int newNode(){
+      nodes.push_back(Node());
+      return (int)nodes.size() - 1;
+    }
+
+    int literalChild(int node, const std::string& segment){
+      std::vector<std::pair<std::string, int> >& literals = nodes[node].literals;
+      std::size_t i = 0;
+      while(i < literals.size() && literals[i].first < segment)
+        ++i;
+      if(i < literals.size() && literals[i].first == segment)
+        return literals[i].second;
+      int child = newNode();
+      nodes[node].literals.insert(nodes[node].literals.begin() + i, std::make_pair(segment, child));
+      return child;
+    }
+
+    /* Skips slashes, returns whether a segment starts at pos. */
+    static bool nextSegment(const char* path, std::size_t len, std::size_t& pos){
+      while(pos < len && path[pos] == '/')
+        ++pos;
+      return pos < len;
+    }
+
+    static int compare(const std::string& literal, const char* segment, std::size_t len){
+      int c = std::memcmp(literal.data(), segment, std::min(literal.size(), len));
+      if(c != 0)
+        return c;
+      return literal.size() < len ? -1 : (literal.size() > len ? 1 : 0);
+    }
+
+    bool matchNode(int index, const char* path, std::size_t len, std::size_t pos,
+                   CDWRouteMatch& result) const {
+      const Node& node = nodes[index];
+      if(!nextSegment(path, len, pos)){
+        if(node.route >= 0){
+          result.route = node.route;
+          return true;
+        }
+        if(node.wildcard >= 0 && nodes[node.wildcard].route >= 0){
+          CDWPathSpan rest = { path + len, 0 };
+          result.params[result.count++] = rest;
+          result.route = nodes[node.wildcard].route;
+          return true;
+        }
+        return false;
+      }
+
+      std::size_t end = pos;
+      while(end < len && path[end] != '/')
+        ++end;
+      const char* segment = path + pos;
+      std::size_t size = end - pos;
+
+      std::size_t lo = 0, hi = node.literals.size();
+      while(lo < hi){
+        std::size_t mid = (lo + hi) / 2;
+        int c = compare(node.literals[mid].first, segment, size);
+        if(c == 0){
+          if(matchNode(node.literals[mid].second, path, len, end, result))
+            return true;
+          break;
+        } else if(c < 0)
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+
+      if(node.param >= 0){
+        int count = result.count;
+        CDWPathSpan param = { segment, size };
+        result.params[result.count++] = param;
+        if(matchNode(node.param, path, len, end, result))
+          return true;
+        result.count = count;
+      }
+
+      if(node.wildcard >= 0 && nodes[node.wildcard].route >= 0){
+        CDWPathSpan rest = { segment, len - pos };
+        result.params[result.count++] = rest;
+        result.route = nodes[node.wildcard].route;
+        return true;
+      }
+      return false;
+    }
+  };
+}
+
+#endif /* CDWROUTER_H_ */
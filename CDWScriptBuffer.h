@@ -0,0 +1,211 @@
+/*
+ * CDWScriptBuffer.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWSCRIPTBUFFER_H_
+#define CDWSCRIPTBUFFER_H_
+
+#include <Wt/WApplication>
+#include <Wt/WContainerWidget>
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+
+namespace Wt {
+
+  /*! \brief JavaScript statistics of a session.
+   */
+  struct CDWScriptStats{
+    std::uint64_t snippets;   //!< Snippets received
+    std::uint64_t duplicates; //!< Snippets dropped as exact duplicates
+    std::uint64_t blocks;     //!< Combined blocks emitted
+  };
+
+  /*! \brief Collects the JavaScript of one response.
+   *
+   * Snippets run after loading are appended to a single block, in call
+   * order, dropping exact duplicates; the block is taken once per render.
+   * Immediate snippets (afterLoaded = \c false) cannot wait for the render,
+   * since %Wt emits them before the DOM changes: they are only
+   * deduplicated against the other immediate snippets of the response.
+   *
+   * Auto JavaScript (WApplication::addAutoJavaScript()) is kept by %Wt for
+   * the whole session and rerun after every DOM change, so duplicates are
+   * dropped for the whole session.
+   */
+  class CDWScriptBuffer{
+  public:
+    CDWScriptBuffer(): minifyValue(false) {
+      stats.snippets = stats.duplicates = stats.blocks = 0;
+    }
+
+    /*! \brief Adds a snippet run after loading.
+     *
+     * Returns \c false when it duplicates one already buffered.
+     */
+    bool add(const std::string& javascript){
+      return append(javascript, afterLoadedSeen, afterLoaded);
+    }
+
+    /*! \brief Registers an immediate snippet.
+     *
+     * Returns \c false when it duplicates one already sent in this
+     * response, otherwise the caller sends it on.
+     */
+    bool addImmediate(const std::string& javascript){
+      ++stats.snippets;
+      if(!immediateSeen.insert(javascript).second){
+        ++stats.duplicates;
+        return false;
+      }
+      return true;
+    }
+
+    /*! \brief Adds auto JavaScript.
+     */
+    bool addAuto(const std::string& javascript){
+      return append(javascript, autoSeen, autoPending);
+    }
+
+    /*! \brief Returns whether anything waits for take().
+     */
+    bool pending() const {
+      return !afterLoaded.empty() || !autoPending.empty();
+    }
+
+    /*! \brief Takes the combined block of snippets run after loading, and
+     *         starts a new response.
+     */
+    std::string take(){
+      std::string block;
+      block.swap(afterLoaded);
+      afterLoadedSeen.clear();
+      immediateSeen.clear();
+      if(!block.empty())
+        ++stats.blocks;
+      return minifyValue ? minify(block) : block;
+    }
+
+    /*! \brief Takes the auto JavaScript added since the last call.
+     */
+    std::string takeAuto(){
+      std::string block;
+      block.swap(autoPending);
+      return minifyValue ? minify(block) : block;
+    }
+
+    /*! \brief Enables whitespace minification of the combined blocks.
+     *
+     * Lines are trimmed and blank lines dropped; line breaks are kept, so
+     * automatic semicolon insertion is unaffected. Snippets must not
+     * contain multi-line string literals whose indentation matters.
+     */
+    void setMinify(bool enabled){
+      minifyValue = enabled;
+    }
+
+    bool minifying() const {
+      return minifyValue;
+    }
+
+    const CDWScriptStats& statistics() const {
+      return stats;
+    }
+
+    /*! \brief Trims every line of \p javascript and drops blank lines.
+     */
+    static std::string minify(const std::string& javascript){
+      std::string result;
+      result.reserve(javascript.size());
+      std::size_t pos = 0;
+      while(pos < javascript.size()){
+        std::size_t end = javascript.find('\n', pos);
+        if(end == std::string::npos)
+          end = javascript.size();
+        std::size_t first = javascript.find_first_not_of(" \t\r", pos);
+        if(first != std::string::npos && first < end){
+          std::size_t last = javascript.find_last_not_of(" \t\r", end - 1);
+          if(!result.empty())
+            result += '\n';
+          result.append(javascript, first, last + 1 - first);
+        }
+        pos = end + 1;
+      }
+      return result;
+    }
+
+  private:
+    bool minifyValue;
+    std::string afterLoaded;
+    std::string autoPending;
+    std::unordered_set<std::string> afterLoadedSeen;
+    std::unordered_set<std::string> immediateSeen;
+    std::unordered_set<std::string> autoSeen;
+    CDWScriptStats stats;
+
+    bool append(const std::string& javascript, std::unordered_set<std::string>& seen,
+                std::string& block){
+      ++stats.snippets;
+      if(!seen.insert(javascript).second){
+        ++stats.duplicates;
+        return false;
+      }
+      std::size_t last = javascript.find_last_not_of(" \t\r\n");
+      if(last == std::string::npos)
+        return true;
+      block.append(javascript, 0, last + 1);
+      if(javascript[last] != ';')
+        block += ';';
+      block += '\n';
+      return true;
+    }
+  };
+
+  /*! \brief Invisible widget that flushes a CDWScriptBuffer when the
+   *         response is rendered.
+   *
+   * %Wt has no hook before rendering a response, but it renders every
+   * widget that asked for it: the flusher asks whenever the buffer gets a
+   * snippet, and hands the combined block to the application from its
+   * render().
+   *
+   * A hidden widget may be sent as a stub and rendered only once shown,
+   * which would keep render() from ever running; the flusher therefore
+   * turns that off.
+   */
+  class CDWScriptFlusher : public WContainerWidget{
+  public:
+    CDWScriptFlusher(CDWScriptBuffer& buffer, WContainerWidget* parent)
+      : WContainerWidget(parent), buffer(buffer)
+    {
+      setLoadLaterWhenInvisible(false);
+      hide();
+    }
+
+    /*! \brief Asks to be rendered with the next response.
+     */
+    void request(){
+      scheduleRender();
+    }
+
+  protected:
+    virtual void render(WFlags<RenderFlag> flags){
+      WApplication* app = WApplication::instance();
+      std::string autoBlock = buffer.takeAuto();
+      if(!autoBlock.empty())
+        app->addAutoJavaScript(autoBlock);
+      std::string block = buffer.take();
+      if(!block.empty())
+        app->doJavaScript(block, true);
+      WContainerWidget::render(flags);
+    }
+
+  private:
+    CDWScriptBuffer& buffer;
+  };
+}
+
+#endif /* CDWSCRIPTBUFFER_H_ */
@@ -0,0 +1,219 @@
+/*
+ * CDWSessionDirectory.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWSESSIONDIRECTORY_H_
+#define CDWSESSIONDIRECTORY_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Wt {
+  class CDWApplication;
+
+  /*! \brief A weak handle on a live application, as stored in the
+   *         CDWSessionDirectory.
+   *
+   * The handle outlives its application: application() returns \c 0 once
+   * the application has quit or was deleted.
+   *
+   * \note The application may only be touched from another thread while
+   *       holding its WApplication::UpdateLock, or from a function posted
+   *       with WServer::post() using sessionId().
+   */
+  class CDWSessionHandle{
+  public:
+    CDWSessionHandle(CDWApplication* application, const std::string& sessionId)
+      : app(application), id(sessionId) {}
+
+    /*! \brief Returns the application, or \c 0 when it is gone.
+     */
+    CDWApplication* application() const {
+      return app.load(std::memory_order_acquire);
+    }
+
+    /*! \brief Returns the current session id.
+     */
+    std::string sessionId() const {
+      std::lock_guard<std::mutex> lock(mutex);
+      return id;
+    }
+
+  private:
+    std::atomic<CDWApplication*> app;
+    mutable std::mutex mutex;
+    std::string id;
+
+    friend class CDWSessionDirectory;
+  };
+
+  /*! \brief Process-wide directory of live applications by session id.
+   *
+   * CDWApplication keeps the directory up to date: it registers itself
+   * when constructed, is re-keyed when its session id changes and removed
+   * by quit(), on destruction, and when %Wt deletes its application.
+   *
+   * The directory is split in shards by the hash of the session id. Each
+   * shard is a fixed array of buckets holding linked lists of immutable
+   * nodes. find() takes no lock and never waits: it announces itself in
+   * its shard's reader count and walks one list. Writers serialize on the
+   * shard's mutex, replace nodes instead of changing them, and free an
+   * unlinked node only once they see no reader in its shard, so a reader
+   * never sees a node freed under it. Under constant lookups, unlinked
+   * nodes wait for the next quiet moment of their shard.
+   */
+  class CDWSessionDirectory{
+  public:
+    /*! \brief Looks up a live application by session id.
+     *
+     * Returns an empty pointer when no live application has this id.
+     * Wait-free.
+     */
+    static std::shared_ptr<CDWSessionHandle> find(const std::string& sessionId){
+      std::size_t hash = std::hash<std::string>()(sessionId);
+      Shard& s = shard(hash);
+      std::shared_ptr<CDWSessionHandle> handle;
+
+      s.readers.fetch_add(1);
+      for(Node* n = s.buckets[bucket(hash)].load(); n; n = n->next.load())
+        if(n->sessionId == sessionId){
+          handle = n->handle.lock();
+          break;
+        }
+      s.readers.fetch_sub(1);
+
+      if(handle && !handle->application())
+        handle.reset();
+      return handle;
+    }
+
+    /*! \brief Registers an application handle.
+     */
+    static void add(const std::shared_ptr<CDWSessionHandle>& handle){
+      update(handle->sessionId(), handle);
+    }
+
+    /*! \brief Moves a handle to a new session id.
+     */
+    static void rename(const std::shared_ptr<CDWSessionHandle>& handle, const std::string& sessionId){
+      std::string previous;
+      {
+        std::lock_guard<std::mutex> lock(handle->mutex);
+        previous = handle->id;
+        handle->id = sessionId;
+      }
+      erase(previous, handle.get());
+      update(sessionId, handle);
+    }
+
+    /*! \brief Removes a handle, and marks its application gone.
+     */
+    static void remove(const std::shared_ptr<CDWSessionHandle>& handle){
+      handle->app.store(0, std::memory_order_release);
+      erase(handle->sessionId(), handle.get());
+    }
+
+  private:
+    enum { Shards = 64, Buckets = 256 };
+
+    /* Immutable once published, except for next. */
+    struct Node{
+      const std::string sessionId;
+      const std::weak_ptr<CDWSessionHandle> handle;
+      std::atomic<Node*> next;
+      Node* retired;
+
+      Node(const std::string& sessionId, const std::shared_ptr<CDWSessionHandle>& handle, Node* next)
+        : sessionId(sessionId), handle(handle), next(next), retired(0) {}
+    };
+
+    struct Shard{
+      std::mutex mutex;
+      std::atomic<unsigned> readers;
+      std::atomic<Node*> buckets[Buckets];
+      Node* retired;
+
+      Shard(): readers(0), retired(0) {
+        for(int i = 0; i < Buckets; ++i)
+          buckets[i].store(0, std::memory_order_relaxed);
+      }
+
+      ~Shard(){
+        for(int i = 0; i < Buckets; ++i)
+          for(Node* n = buckets[i].load(); n; ){
+            Node* next = n->next.load();
+            delete n;
+            n = next;
+          }
+        reclaim();
+      }
+
+      /* Called with the mutex held, after n was unlinked. */
+      void retire(Node* n){
+        n->retired = retired;
+        retired = n;
+        if(readers.load() == 0)
+          reclaim();
+      }
+
+      void reclaim(){
+        while(retired){
+          Node* n = retired;
+          retired = n->retired;
+          delete n;
+        }
+      }
+    };
+
+    static Shard& shard(std::size_t hash){
+      static Shard shards[Shards];
+      return shards[hash % Shards];
+    }
+
+    static std::size_t bucket(std::size_t hash){
+      return (hash / Shards) % Buckets;
+    }
+
+    /* Called with the shard's mutex held: unlinks the node of sessionId,
+       unless it belongs to another handle than owner (0 for any). */
+    static void unlink(Shard& s, std::atomic<Node*>& head, const std::string& sessionId,
+                       const CDWSessionHandle* owner){
+      std::atomic<Node*>* link = &head;
+      for(Node* n = link->load(); n; link = &n->next, n = link->load()){
+        if(n->sessionId != sessionId)
+          continue;
+        std::shared_ptr<CDWSessionHandle> current = n->handle.lock();
+        if(owner && current && current.get() != owner)
+          return;
+        link->store(n->next.load());
+        s.retire(n);
+        return;
+      }
+    }
+
+    static void update(const std::string& sessionId, const std::shared_ptr<CDWSessionHandle>& handle){
+      std::size_t hash = std::hash<std::string>()(sessionId);
+      Shard& s = shard(hash);
+      std::atomic<Node*>& head = s.buckets[bucket(hash)];
+      std::lock_guard<std::mutex> lock(s.mutex);
+      unlink(s, head, sessionId, 0);
+      head.store(new Node(sessionId, handle, head.load()));
+    }
+
+    /* Erases the entry, unless it was taken over by another handle. */
+    static void erase(const std::string& sessionId, const CDWSessionHandle* owner){
+      std::size_t hash = std::hash<std::string>()(sessionId);
+      Shard& s = shard(hash);
+      std::lock_guard<std::mutex> lock(s.mutex);
+      unlink(s, s.buckets[bucket(hash)], sessionId, owner);
+    }
+  };
+}
+
+#endif /* CDWSESSIONDIRECTORY_H_ */
@@ -0,0 +1,292 @@
+/*
+ * CDWSessionExecutor.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWSESSIONEXECUTOR_H_
+#define CDWSESSIONEXECUTOR_H_
+
+#include <Wt/WServer>
+#include "CDWAdmission.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace Wt {
+
+  /*! \brief A closure posted to a session: \p function is called with
+   *         \p payload from within the session.
+   */
+  typedef void (*CDWPostedFunction)(void* payload);
+
+  /*! \brief Outcome of CDWSessionExecutor::post().
+   */
+  enum CDWPostResult {
+    PostAccepted,  //!< The closure was queued
+    PostQueueFull, //!< The queue is full, retry later or drop
+    PostNoSession  //!< The server is not running, or the session ended
+  };
+
+  /*! \brief Runs closures posted from any thread within a session, in
+   *         batches.
+   *
+   * Modifying a session from a worker thread normally means taking the
+   * application's update lock and calling triggerUpdate() for every
+   * change. Closures posted here are instead queued in a bounded
+   * multi-producer, single-consumer queue. The first closure queued after
+   * a drain schedules one WServer::post() to the session; that drain runs
+   * every queued closure under the single session lock it holds, and then
+   * calls triggerUpdate() once.
+   *
+   * A full queue is reported to the producer (PostQueueFull) rather than
+   * blocking it, so it can back off or drop the update.
+   *
+   * The executor is shared: producers keep it alive with the
+   * std::shared_ptr returned by CDWApplication::executor(), after the
+   * session may be gone. Closures queued for a session that has ended are
+   * never run: their discard function, if any, is called instead, from
+   * the thread that ends the session. They stop counting towards
+   * CDWAdmission's queue depth when the session ends, and later posts are
+   * refused.
+   *
+   * The queue is allocated by the first post(), so sessions that never
+   * receive one do not pay for it.
+   */
+  class CDWSessionExecutor : public std::enable_shared_from_this<CDWSessionExecutor>{
+  public:
+    /*! \brief Creates an executor for a session.
+     *
+     * The \p capacity is rounded up to a power of two.
+     */
+    CDWSessionExecutor(const std::string& sessionId, std::size_t capacity = 1024)
+      : sessionIdValue(sessionId),
+        cells(0),
+        scheduled(false),
+        closed(false),
+        enqueuePos(0),
+        dequeuePos(0),
+        acceptedCount(0),
+        rejectedCount(0),
+        batchCount(0)
+    {
+      std::size_t size = 2;
+      while(size < capacity)
+        size <<= 1;
+      mask = size - 1;
+    }
+
+    ~CDWSessionExecutor(){
+      discardAll();
+      delete[] cells.load(std::memory_order_relaxed);
+    }
+
+    /*! \brief Posts a closure to the session.
+     *
+     * May be called from any thread. When the closure is dropped instead
+     * of run, because the session ended, \p discard is called with
+     * \p payload, so that it can be released.
+     */
+    CDWPostResult post(CDWPostedFunction function, void* payload, CDWPostedFunction discard = 0){
+      WServer* server = WServer::instance();
+      if(!server || closed.load(std::memory_order_acquire))
+        return PostNoSession;
+      if(!push(function, payload, discard)){
+        rejectedCount.fetch_add(1, std::memory_order_relaxed);
+        return PostQueueFull;
+      }
+      acceptedCount.fetch_add(1, std::memory_order_relaxed);
+      CDWAdmission::queued(1);
+
+      if(!scheduled.exchange(true, std::memory_order_acq_rel))
+        scheduleDrain(server);
+      return PostAccepted;
+    }
+
+    /*! \brief Returns the number of queued closures.
+     */
+    std::size_t size() const {
+      return enqueuePos.load(std::memory_order_relaxed) - dequeuePos.load(std::memory_order_relaxed);
+    }
+
+    /*! \brief Returns the queue capacity.
+     */
+    std::size_t capacity() const { return mask + 1; }
+
+    /*! \brief Returns the number of closures accepted so far.
+     */
+    std::uint64_t accepted() const { return acceptedCount.load(std::memory_order_relaxed); }
+
+    /*! \brief Returns the number of closures rejected because the queue was
+     *         full.
+     */
+    std::uint64_t rejected() const { return rejectedCount.load(std::memory_order_relaxed); }
+
+    /*! \brief Returns the number of batches drained.
+     */
+    std::uint64_t batches() const { return batchCount.load(std::memory_order_relaxed); }
+
+    /*! \brief Changes the session the closures are posted to.
+     *
+     * Called by CDWApplication::changeSessionId(), from within the session.
+     */
+    void setSessionId(const std::string& sessionId){
+      std::lock_guard<std::mutex> lock(idMutex);
+      sessionIdValue = sessionId;
+    }
+
+    std::string sessionId() const {
+      std::lock_guard<std::mutex> lock(idMutex);
+      return sessionIdValue;
+    }
+
+    /*! \brief Discards the queued closures, and refuses new ones.
+     *
+     * Called by CDWApplication when its session ends; no drain can run
+     * anymore. The discard functions of the queued closures are called.
+     */
+    void close(){
+      closed.store(true, std::memory_order_release);
+      discardAll();
+    }
+
+    /*! \brief Sets the function that propagates the changes of a batch.
+     *
+     * It is called from within the session after each batch. CDWApplication
+     * sets it to CDWApplication::triggerCurrentUpdate(); without one, no
+     * update is pushed.
+     */
+    void setUpdateFunction(const std::function<void ()>& function){
+      updateFunction = function;
+    }
+
+  private:
+    /* Bounded queue of D. Vyukov: each cell's sequence tells whose turn it is. */
+    struct Cell{
+      std::atomic<std::size_t> sequence;
+      CDWPostedFunction function;
+      CDWPostedFunction discard;
+      void* payload;
+    };
+
+    mutable std::mutex idMutex;
+    std::string sessionIdValue;
+    std::once_flag allocated;
+    std::atomic<Cell*> cells;
+    std::size_t mask;
+    std::atomic<bool> scheduled;
+    std::atomic<bool> closed;
+    std::atomic<std::size_t> enqueuePos;
+    std::atomic<std::size_t> dequeuePos;
+    std::atomic<std::uint64_t> acceptedCount;
+    std::atomic<std::uint64_t> rejectedCount;
+    std::atomic<std::uint64_t> batchCount;
+    std::function<void ()> updateFunction;
+
+    void allocate(){
+      Cell* ring = new Cell[mask + 1];
+      for(std::size_t i = 0; i <= mask; ++i)
+        ring[i].sequence.store(i, std::memory_order_relaxed);
+      cells.store(ring, std::memory_order_release);
+    }
+
+    bool push(CDWPostedFunction function, void* payload, CDWPostedFunction discard){
+      std::call_once(allocated, &CDWSessionExecutor::allocate, this);
+      Cell* ring = cells.load(std::memory_order_acquire);
+      std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+      Cell* cell;
+      for(;;){
+        cell = &ring[pos & mask];
+        std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        std::intptr_t diff = (std::intptr_t)sequence - (std::intptr_t)pos;
+        if(diff == 0){
+          if(enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+        } else if(diff < 0)
+          return false;
+        else
+          pos = enqueuePos.load(std::memory_order_relaxed);
+      }
+      cell->function = function;
+      cell->discard = discard;
+      cell->payload = payload;
+      cell->sequence.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool pop(CDWPostedFunction& function, CDWPostedFunction& discard, void*& payload){
+      Cell* ring = cells.load(std::memory_order_acquire);
+      if(!ring)
+        return false;
+      std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+      Cell* cell = &ring[pos & mask];
+      std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      if((std::intptr_t)sequence - (std::intptr_t)(pos + 1) < 0)
+        return false;
+      function = cell->function;
+      discard = cell->discard;
+      payload = cell->payload;
+      dequeuePos.store(pos + 1, std::memory_order_relaxed);
+      cell->sequence.store(pos + mask + 1, std::memory_order_release);
+      return true;
+    }
+
+    void discardAll(){
+      CDWPostedFunction function, discard;
+      void* payload;
+      while(pop(function, discard, payload)){
+        CDWAdmission::queued(-1);
+        if(discard)
+          discard(payload);
+      }
+    }
+
+    /*
+     * Posts a drain to the current session id. When the post cannot be
+     * delivered, because the session id changed meanwhile, the drain is
+     * posted again to the new id; when the session is gone, close()
+     * discards the queue.
+     */
+    void scheduleDrain(WServer* server){
+      std::shared_ptr<CDWSessionExecutor> self = shared_from_this();
+      std::string id = sessionId();
+      server->post(id, [self](){ self->drain(); }, [self, id](){ self->drainLost(id); });
+    }
+
+    void drainLost(const std::string& id){
+      scheduled.store(false, std::memory_order_release);
+      if(closed.load(std::memory_order_acquire) || size() == 0 || sessionId() == id)
+        return;
+      WServer* server = WServer::instance();
+      if(server && !scheduled.exchange(true, std::memory_order_acq_rel))
+        scheduleDrain(server);
+    }
+
+    /* Runs within the session, holding its lock. */
+    void drain(){
+      scheduled.store(false, std::memory_order_release);
+
+      CDWPostedFunction function, discard;
+      void* payload;
+      bool any = false;
+      while(pop(function, discard, payload)){
+        CDWAdmission::queued(-1);
+        function(payload);
+        any = true;
+      }
+
+      if(any){
+        batchCount.fetch_add(1, std::memory_order_relaxed);
+        if(updateFunction)
+          updateFunction();
+      }
+    }
+  };
+}
+
+#endif /* CDWSESSIONEXECUTOR_H_ */
@@ -0,0 +1,106 @@
+/*
+ * CDWSharedStyleSheet.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWSHAREDSTYLESHEET_H_
+#define CDWSHAREDSTYLESHEET_H_
+
+#include <Wt/WException>
+#include <Wt/WServer>
+#include "CDWStaticResource.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+namespace Wt {
+
+  /*! \brief A style sheet shared by all sessions.
+   *
+   * Rules that every session would add to its inline
+   * WApplication::styleSheet() are added here once, at startup. publish()
+   * serializes them into one CDWStaticResource; sessions then only link
+   * to it with CDWApplication::useStyleSheet(const CDWSharedStyleSheet&),
+   * so they neither keep the rules in memory nor serialize them, and
+   * clients cache the file across sessions.
+   *
+   * \code
+   * static CDWSharedStyleSheet theme;
+   * theme.addRule(".toolbar", "padding: 2px; background: #eee;");
+   * theme.publish(server);
+   * ...
+   * app->useStyleSheet(theme);
+   * \endcode
+   *
+   * Identical rules are only included once. After publish() the style
+   * sheet is immutable and may be used by any session without locking.
+   */
+  class CDWSharedStyleSheet{
+  public:
+    CDWSharedStyleSheet(): published(false), resource(0) {}
+
+    /*! \brief Adds a rule.
+     */
+    void addRule(const std::string& selector, const std::string& declarations){
+      addCss(selector + " { " + declarations + " }");
+    }
+
+    /*! \brief Adds CSS text, such as the contents of a .css file, or an
+     *         \@media block.
+     */
+    void addCss(const std::string& css){
+      std::lock_guard<std::mutex> lock(mutex);
+      checkMutable();
+      if(seen.insert(css).second){
+        text += css;
+        text += '\n';
+      }
+    }
+
+    /*! \brief Builds the style sheet and adds it to \p server.
+     *
+     * Must be called once, before the server is started.
+     */
+    void publish(WServer& server){
+      std::lock_guard<std::mutex> lock(mutex);
+      checkMutable();
+      resource = new CDWStaticResource(text, "text/css", "/cdw/", ".css");
+      resource->publish(server);
+      std::string().swap(text);
+      seen.clear();
+      published.store(true, std::memory_order_release);
+    }
+
+    bool isPublished() const {
+      return published.load(std::memory_order_acquire);
+    }
+
+    /*! \brief Returns the URL of the published style sheet.
+     */
+    const std::string& url() const {
+      if(!isPublished())
+        throw WException("CDWSharedStyleSheet: not published");
+      return resource->path();
+    }
+
+  private:
+    std::mutex mutex;
+    std::atomic<bool> published;
+    std::string text;
+    std::unordered_set<std::string> seen;
+    CDWStaticResource* resource;
+
+    CDWSharedStyleSheet(const CDWSharedStyleSheet&);
+    CDWSharedStyleSheet& operator=(const CDWSharedStyleSheet&);
+
+    void checkMutable(){
+      if(published.load(std::memory_order_acquire))
+        throw WException("CDWSharedStyleSheet: already published");
+    }
+  };
+}
+
+#endif /* CDWSHAREDSTYLESHEET_H_ */
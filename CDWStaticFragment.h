@@ -0,0 +1,232 @@
+/*
+ * CDWStaticFragment.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWSTATICFRAGMENT_H_
+#define CDWSTATICFRAGMENT_H_
+
+#include <Wt/WApplication>
+#include <Wt/WObject>
+#include <Wt/WString>
+#include <Wt/WText>
+#include <Wt/WTheme>
+#include <Wt/WWidget>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Wt {
+
+  /*! \brief Builds the widget subtree of a static fragment.
+   */
+  typedef WWidget* (*CDWFragmentBuilder)(void* userData);
+
+  /*! \brief Prerendered HTML, rendered once for all sessions.
+   *
+   * Headers, footers and help panels that are the same for every session
+   * are built as widgets once per (fragment id, locale, theme), rendered
+   * to HTML with WWidget::htmlText(), and cached process-wide. Sessions
+   * then show the cached HTML in a single WText, instead of a subtree of
+   * live widgets that is built and serialized again for every session.
+   * The rendering is shared; each WText still holds its own copy of the
+   * HTML.
+   *
+   * A fragment is static: its widgets exist only while it is rendered,
+   * so it must not rely on signals, JavaScript or later updates. Changed
+   * content is published with invalidate().
+   *
+   * The ids of the rendered widgets belong to the session that built
+   * them and would clash in others, so they are stripped from the HTML,
+   * together with the \c for attributes referring to them: style
+   * fragments with classes, not ids.
+   */
+  class CDWStaticFragment{
+  public:
+    /*! \brief Creates a widget showing a fragment.
+     *
+     * Must be called from within a session, whose locale and theme select
+     * the rendered HTML. When the HTML is not cached yet, \p builder
+     * creates the widgets to render, which are deleted afterwards.
+     */
+    static WText* create(const std::string& id, CDWFragmentBuilder builder, void* userData = 0){
+      std::shared_ptr<const std::string> html = render(id, builder, userData);
+      return new WText(WString::fromUTF8(*html, false), XHTMLUnsafeText);
+    }
+
+    /*! \brief Returns the HTML of a fragment for the current session.
+     */
+    static std::shared_ptr<const std::string> render(const std::string& id, CDWFragmentBuilder builder,
+                                                     void* userData = 0){
+      WApplication* app = WApplication::instance();
+      Key key(id, app->locale().name(), app->theme() ? app->theme()->name() : std::string());
+
+      CDWStaticFragment& f = instance();
+      {
+        std::lock_guard<std::mutex> lock(f.mutex);
+        Cache::const_iterator i = f.cache.find(key);
+        if(i != f.cache.end())
+          return i->second;
+      }
+
+      std::unique_ptr<WWidget> widget(builder(userData));
+      std::ostringstream out;
+      widget->htmlText(out);
+      std::vector<std::string> ids;
+      collectIds(widget.get(), ids);
+      std::shared_ptr<const std::string> html
+        = std::make_shared<const std::string>(stripIds(out.str(), ids));
+
+      std::lock_guard<std::mutex> lock(f.mutex);
+      return f.cache.insert(std::make_pair(key, html)).first->second;
+    }
+
+    /*! \brief Drops the cached HTML of a fragment, for all locales and
+     *         themes.
+     *
+     * Widgets already created keep showing the previous HTML.
+     */
+    static void invalidate(const std::string& id){
+      CDWStaticFragment& f = instance();
+      std::lock_guard<std::mutex> lock(f.mutex);
+      Cache::iterator i = f.cache.lower_bound(Key(id, std::string(), std::string()));
+      while(i != f.cache.end() && i->first.id == id)
+        f.cache.erase(i++);
+    }
+
+    /*! \brief Drops all cached HTML.
+     */
+    static void invalidateAll(){
+      CDWStaticFragment& f = instance();
+      std::lock_guard<std::mutex> lock(f.mutex);
+      f.cache.clear();
+    }
+
+  private:
+    struct Key{
+      std::string id;
+      std::string locale;
+      std::string theme;
+
+      Key(const std::string& id, const std::string& locale, const std::string& theme)
+        : id(id), locale(locale), theme(theme) {}
+
+      bool operator<(const Key& other) const {
+        if(id != other.id)
+          return id < other.id;
+        if(locale != other.locale)
+          return locale < other.locale;
+        return theme < other.theme;
+      }
+    };
+
+    typedef std::map<Key, std::shared_ptr<const std::string> > Cache;
+
+    std::mutex mutex;
+    Cache cache;
+
+    static void collectIds(WObject* object, std::vector<std::string>& ids){
+      if(WWidget* w = dynamic_cast<WWidget*>(object))
+        ids.push_back(w->id());
+      const std::vector<WObject*>& children = object->children();
+      for(std::size_t i = 0; i < children.size(); ++i)
+        collectIds(children[i], ids);
+    }
+
+    /* Removes the id and for attributes whose value starts with one of
+       ids: widgets also derive the ids of inner elements from their own.
+       Only attributes inside tags are touched, not text or comments. */
+    static std::string stripIds(const std::string& html, const std::vector<std::string>& ids){
+      std::string result;
+      result.reserve(html.size());
+      std::size_t pos = 0;
+      for(;;){
+        std::size_t open = html.find('<', pos);
+        if(open == std::string::npos)
+          break;
+        if(html.compare(open, 4, "<!--") == 0){
+          std::size_t close = html.find("-->", open + 4);
+          close = close == std::string::npos ? html.size() : close + 3;
+          result.append(html, pos, close - pos);
+          pos = close;
+          continue;
+        }
+        result.append(html, pos, open + 1 - pos);
+        pos = stripTag(html, open + 1, ids, result);
+      }
+      result.append(html, pos, std::string::npos);
+      return result;
+    }
+
+    /* Copies the tag whose name starts at pos, up to and including its
+       '>', without the owned id and for attributes. Returns the position
+       after the tag. */
+    static std::size_t stripTag(const std::string& html, std::size_t pos,
+                                const std::vector<std::string>& ids, std::string& result){
+      const std::size_t n = html.size();
+      while(pos < n && html[pos] != '>'){
+        const std::size_t space = pos;
+        while(pos < n && isSpace(html[pos]))
+          ++pos;
+        const std::size_t name = pos;
+        while(pos < n && !isSpace(html[pos]) && html[pos] != '=' && html[pos] != '>')
+          ++pos;
+        const std::size_t nameEnd = pos;
+
+        bool owned = false;
+        if(pos < n && html[pos] == '='){
+          ++pos;
+          if(pos < n && (html[pos] == '"' || html[pos] == '\'')){
+            std::size_t close = html.find(html[pos], pos + 1);
+            if(close == std::string::npos)
+              pos = n;
+            else {
+              owned = space < name && isIdAttribute(html, name, nameEnd)
+                  && ownedId(html, pos + 1, close, ids);
+              pos = close + 1;
+            }
+          } else
+            while(pos < n && !isSpace(html[pos]) && html[pos] != '>')
+              ++pos;
+        }
+        if(!owned)
+          result.append(html, space, pos - space);
+      }
+      if(pos < n){
+        result += '>';
+        ++pos;
+      }
+      return pos;
+    }
+
+    static bool isSpace(char c){
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+    }
+
+    static bool isIdAttribute(const std::string& html, std::size_t begin, std::size_t end){
+      return (end - begin == 2 && html.compare(begin, 2, "id") == 0)
+          || (end - begin == 3 && html.compare(begin, 3, "for") == 0);
+    }
+
+    static bool ownedId(const std::string& html, std::size_t begin, std::size_t end,
+                        const std::vector<std::string>& ids){
+      for(std::size_t i = 0; i < ids.size(); ++i)
+        if(!ids[i].empty() && ids[i].size() <= end - begin
+           && html.compare(begin, ids[i].size(), ids[i]) == 0)
+          return true;
+      return false;
+    }
+
+    static CDWStaticFragment& instance(){
+      static CDWStaticFragment fragments;
+      return fragments;
+    }
+  };
+}
+
+#endif /* CDWSTATICFRAGMENT_H_ */
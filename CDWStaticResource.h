@@ -0,0 +1,104 @@
+/*
+ * CDWStaticResource.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWSTATICRESOURCE_H_
+#define CDWSTATICRESOURCE_H_
+
+#include <Wt/WResource>
+#include <Wt/WServer>
+#include <Wt/Http/Request>
+#include <Wt/Http/Response>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace Wt {
+
+  /*! \brief Immutable content shared by all sessions, at a fingerprinted
+   *         URL.
+   *
+   * The URL contains a hash of the content, so the content behind a URL
+   * never changes and clients may cache it forever: the resource is
+   * served with a one year, immutable Cache-Control and an ETag. A new
+   * content gets a new URL.
+   *
+   * Static resources are added to the server with WServer::addResource(),
+   * before the server is started, and live as long as the server.
+   */
+  class CDWStaticResource : public WResource{
+  public:
+    /*! \brief Creates a resource for \p content.
+     *
+     * Its path is \p prefix, the fingerprint and \p extension, for example
+     * <tt>/cdw/3f2a9c0e5b1d7a64.js</tt>.
+     */
+    CDWStaticResource(const std::string& content, const std::string& mimeType,
+                      const std::string& prefix, const std::string& extension)
+      : content(content), mimeType(mimeType),
+        fingerprintValue(fingerprint(content))
+    {
+      pathValue = prefix + fingerprintValue + extension;
+    }
+
+    virtual ~CDWStaticResource(){
+      beingDeleted();
+    }
+
+    /*! \brief Adds the resource to \p server at path().
+     */
+    void publish(WServer& server){
+      server.addResource(this, pathValue);
+    }
+
+    /*! \brief Returns the path of the resource, which is also its URL.
+     */
+    const std::string& path() const {
+      return pathValue;
+    }
+
+    const std::string& fingerprint() const {
+      return fingerprintValue;
+    }
+
+    std::size_t size() const {
+      return content.size();
+    }
+
+    /*! \brief Returns the 64-bit FNV-1a hash of \p data, in hex.
+     */
+    static std::string fingerprint(const std::string& data){
+      std::uint64_t hash = 14695981039346656037ULL;
+      for(std::size_t i = 0; i < data.size(); ++i){
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+      }
+      char buf[17];
+      std::snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)hash);
+      return buf;
+    }
+
+    virtual void handleRequest(const Http::Request& request, Http::Response& response){
+      std::string etag = "\"" + fingerprintValue + "\"";
+      response.addHeader("Cache-Control", "public, max-age=31536000, immutable");
+      response.addHeader("ETag", etag);
+      if(request.headerValue("If-None-Match") == etag){
+        response.setStatus(304);
+        return;
+      }
+      response.setMimeType(mimeType);
+      response.out().write(content.data(), content.size());
+    }
+
+  private:
+    const std::string content;
+    const std::string mimeType;
+    std::string fingerprintValue;
+    std::string pathValue;
+  };
+}
+
+#endif /* CDWSTATICRESOURCE_H_ */
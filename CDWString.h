@@ -0,0 +1,51 @@
+/*
+ * CDWString.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWSTRING_H_
+#define CDWSTRING_H_
+
+#include <Wt/WString>
+#include "CDWUtf8.h"
+
+#include <cstddef>
+#include <string>
+
+namespace Wt {
+
+  /*! \brief Creates a WString from UTF-8 bytes.
+   *
+   * A WString keeps its value as UTF-8, so the bytes are stored as they
+   * are: no transcoding happens, neither here nor when the string is
+   * rendered. The input need not be null-terminated.
+   *
+   * The bytes are validated first; invalid input is sanitized by
+   * WString::fromUTF8().
+   */
+  inline WString utf8String(const char* utf8, std::size_t len){
+    return WString::fromUTF8(std::string(utf8, len), !CDWUtf8::validate(utf8, len));
+  }
+
+  /*! \brief Creates a WString from a wide string.
+   *
+   * Unlike the WString(const wchar_t*) constructor, this does not depend
+   * on the server locale.
+   */
+  inline WString wideString(const wchar_t* wide, std::size_t len){
+    std::string utf8(len * 4, '\0');
+    utf8.resize(CDWUtf8::fromWide(wide, len, len ? &utf8[0] : 0));
+    return WString::fromUTF8(utf8);
+  }
+
+  /*! \brief Returns the value of a WString as a wide string.
+   *
+   * Unlike WString::value(), this does not depend on the server locale.
+   */
+  inline std::wstring toWide(const WString& s){
+    return CDWUtf8::toWString(s.toUTF8());
+  }
+}
+
+#endif /* CDWSTRING_H_ */
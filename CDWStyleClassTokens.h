@@ -0,0 +1,253 @@
+/*
+ * CDWStyleClassTokens.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWSTYLECLASSTOKENS_H_
+#define CDWSTYLECLASSTOKENS_H_
+
+#include <Wt/WException>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Wt {
+
+  /*! \brief An interned style class.
+   *
+   * Tokens are process-wide: the same style class always yields the same
+   * token, in every session.
+   */
+  typedef unsigned short CDWStyleToken;
+
+  /*! \brief Process-wide table of interned style classes.
+   *
+   * Interned classes are never freed, so only intern a fixed vocabulary of
+   * classes, not generated ones such as \c row-1234: at most 65536
+   * classes can be interned. Names are kept in append-only chunks, so
+   * name() never takes a lock: a name is written before its token is
+   * returned, and a chunk is only published once its first name is
+   * written. Hand tokens to other threads through a lock or
+   * WServer::post(), as any other value.
+   */
+  class CDWStyleClassTokens{
+  public:
+    /*! \brief Interns a single style class and returns its token.
+     *
+     * The style class should not contain whitespace. Throws a WException
+     * when the table is full.
+     */
+    static CDWStyleToken intern(const std::string& styleClass){
+      CDWStyleClassTokens& t = table();
+      std::lock_guard<std::mutex> lock(t.mutex);
+      std::unordered_map<std::string, CDWStyleToken>::const_iterator i = t.tokens.find(styleClass);
+      if(i != t.tokens.end())
+        return i->second;
+
+      std::size_t count = t.tokens.size();
+      if(count == MaxTokens)
+        throw WException("CDWStyleClassTokens: too many style classes");
+      std::string* chunk = t.chunks[count / ChunkSize].load(std::memory_order_relaxed);
+      if(chunk)
+        chunk[count % ChunkSize] = styleClass;
+      else {
+        chunk = new std::string[ChunkSize];
+        chunk[count % ChunkSize] = styleClass;
+        t.chunks[count / ChunkSize].store(chunk, std::memory_order_release);
+      }
+      CDWStyleToken token = (CDWStyleToken)count;
+      t.tokens[styleClass] = token;
+      return token;
+    }
+
+    /*! \brief Looks up the token of a style class without interning it.
+     *
+     * Returns false when the class was never interned.
+     */
+    static bool find(const std::string& styleClass, CDWStyleToken& token){
+      CDWStyleClassTokens& t = table();
+      std::lock_guard<std::mutex> lock(t.mutex);
+      std::unordered_map<std::string, CDWStyleToken>::const_iterator i = t.tokens.find(styleClass);
+      if(i == t.tokens.end())
+        return false;
+      token = i->second;
+      return true;
+    }
+
+    /*! \brief Returns the style class of a token.
+     *
+     * The reference stays valid for the lifetime of the process.
+     */
+    static const std::string& name(CDWStyleToken token){
+      return table().chunks[token / ChunkSize].load(std::memory_order_acquire)[token % ChunkSize];
+    }
+
+  private:
+    enum { ChunkSize = 256, MaxTokens = 0x10000 };
+
+    std::mutex mutex;
+    std::atomic<std::string*> chunks[MaxTokens / ChunkSize];
+    std::unordered_map<std::string, CDWStyleToken> tokens;
+
+    CDWStyleClassTokens(){
+      for(std::size_t i = 0; i < MaxTokens / ChunkSize; ++i)
+        chunks[i].store(0, std::memory_order_relaxed);
+    }
+
+    static CDWStyleClassTokens& table(){
+      static CDWStyleClassTokens instance;
+      return instance;
+    }
+  };
+
+  /*! \brief A compact set of style classes.
+   *
+   * Interned classes are kept as sorted tokens, so adding, removing and
+   * testing them are integer operations. Other classes, given as strings,
+   * are kept as sorted strings and are never interned. A class is in the
+   * set at most once, as a token or as a string.
+   */
+  class CDWStyleClassSet{
+  public:
+    /*! \brief Adds a token, returns whether the set changed.
+     */
+    bool add(CDWStyleToken token){
+      std::vector<CDWStyleToken>::iterator i = std::lower_bound(tokens.begin(), tokens.end(), token);
+      if(i != tokens.end() && *i == token)
+        return false;
+      tokens.insert(i, token);
+      return !eraseClass(CDWStyleClassTokens::name(token));
+    }
+
+    /*! \brief Removes a token, returns whether the set changed.
+     */
+    bool remove(CDWStyleToken token){
+      std::vector<CDWStyleToken>::iterator i = std::lower_bound(tokens.begin(), tokens.end(), token);
+      if(i == tokens.end() || *i != token)
+        return eraseClass(CDWStyleClassTokens::name(token));
+      tokens.erase(i);
+      return true;
+    }
+
+    /*! \brief Returns whether the set contains a token.
+     */
+    bool contains(CDWStyleToken token) const{
+      return std::binary_search(tokens.begin(), tokens.end(), token)
+          || std::binary_search(classes.begin(), classes.end(), CDWStyleClassTokens::name(token));
+    }
+
+    /*! \brief Adds the classes of a space separated class string.
+     *
+     * Returns whether the set changed.
+     */
+    bool add(const std::string& styleClasses){
+      std::vector<std::string> parsed = split(styleClasses);
+      bool changed = false;
+      for(std::size_t i = 0; i < parsed.size(); ++i){
+        if(findToken(parsed[i]) != tokens.end())
+          continue;
+        std::vector<std::string>::iterator c = std::lower_bound(classes.begin(), classes.end(), parsed[i]);
+        if(c == classes.end() || *c != parsed[i]){
+          classes.insert(c, parsed[i]);
+          changed = true;
+        }
+      }
+      return changed;
+    }
+
+    /*! \brief Removes the classes of a space separated class string.
+     *
+     * Returns whether the set changed.
+     */
+    bool remove(const std::string& styleClasses){
+      std::vector<std::string> parsed = split(styleClasses);
+      bool changed = false;
+      for(std::size_t i = 0; i < parsed.size(); ++i){
+        std::vector<CDWStyleToken>::iterator t = findToken(parsed[i]);
+        if(t != tokens.end()){
+          tokens.erase(t);
+          changed = true;
+        } else
+          changed = eraseClass(parsed[i]) || changed;
+      }
+      return changed;
+    }
+
+    /*! \brief Replaces the set with the classes of a class string.
+     *
+     * Returns whether the set changed.
+     */
+    bool assign(const std::string& styleClasses){
+      std::vector<std::string> parsed = split(styleClasses);
+      if(tokens.empty() && parsed == classes)
+        return false;
+      tokens.clear();
+      classes.swap(parsed);
+      return true;
+    }
+
+    /*! \brief Returns the class string for this set.
+     */
+    std::string str() const{
+      std::string result;
+      for(std::size_t i = 0; i < tokens.size(); ++i){
+        if(!result.empty())
+          result += ' ';
+        result += CDWStyleClassTokens::name(tokens[i]);
+      }
+      for(std::size_t i = 0; i < classes.size(); ++i){
+        if(!result.empty())
+          result += ' ';
+        result += classes[i];
+      }
+      return result;
+    }
+
+    /*! \brief Splits a space separated class string into sorted, unique
+     *         classes.
+     */
+    static std::vector<std::string> split(const std::string& styleClasses){
+      std::vector<std::string> result;
+      std::size_t begin = 0;
+      while(begin < styleClasses.size()){
+        std::size_t end = styleClasses.find(' ', begin);
+        if(end == std::string::npos)
+          end = styleClasses.size();
+        if(end > begin)
+          result.push_back(styleClasses.substr(begin, end - begin));
+        begin = end + 1;
+      }
+      std::sort(result.begin(), result.end());
+      result.erase(std::unique(result.begin(), result.end()), result.end());
+      return result;
+    }
+
+  private:
+    std::vector<CDWStyleToken> tokens;
+    std::vector<std::string> classes;
+
+    /* Finds the class through the table's hash index, then by token. */
+    std::vector<CDWStyleToken>::iterator findToken(const std::string& styleClass){
+      CDWStyleToken token;
+      if(tokens.empty() || !CDWStyleClassTokens::find(styleClass, token))
+        return tokens.end();
+      std::vector<CDWStyleToken>::iterator i = std::lower_bound(tokens.begin(), tokens.end(), token);
+      return i != tokens.end() && *i == token ? i : tokens.end();
+    }
+
+    bool eraseClass(const std::string& styleClass){
+      std::vector<std::string>::iterator c = std::lower_bound(classes.begin(), classes.end(), styleClass);
+      if(c == classes.end() || *c != styleClass)
+        return false;
+      classes.erase(c);
+      return true;
+    }
+  };
+}
+
+#endif /* CDWSTYLECLASSTOKENS_H_ */
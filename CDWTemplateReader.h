@@ -0,0 +1,169 @@
+/*
+ * CDWTemplateReader.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWTEMPLATEREADER_H_
+#define CDWTEMPLATEREADER_H_
+
+#include <Wt/WException>
+#include "CDWWidgetTemplate.h"
+#include "CDWString.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace Wt {
+
+  /*! \brief Reads a widget tree description into a CDWWidgetTemplate.
+   *
+   * Lets foreign code describe a whole view in one buffer, instead of
+   * constructing it with one binding call per widget and property. The
+   * description is a compact binary format; integers are little endian:
+   *
+   * \code
+   * description := "CDWT" u8:version(1) u32:nodeCount node*
+   * node        := u8:kind i32:parent u8:propertyCount property*
+   * property    := u8:Text        u32:length bytes   UTF-8 text
+   *              | u8:StyleClass  u32:length bytes
+   *              | u8:ObjectName  u32:length bytes
+   *              | u8:Link        u32:length bytes   anchor or image URL
+   *              | u8:Inline
+   *              | u8:Hidden
+   *              | u8:Attribute   u32:length bytes u32:length bytes
+   *              | u8:Bind        u8:event i32:listenerId
+   * \endcode
+   *
+   * \c kind is a CDWWidgetKind, \c event a CDWWidgetEvent, and \c parent
+   * the index of an earlier container node, or -1. Text and attribute
+   * values are validated as UTF-8, see utf8String(). A malformed
+   * description, or a binding to an event the widget kind cannot emit
+   * (see CDWWidgetTemplate::canBind()), throws a WException, after the
+   * nodes read so far were added.
+   *
+   * \sa CDWApplication::build()
+   */
+  class CDWTemplateReader{
+  public:
+    /*! \brief Property tags.
+     */
+    enum Property {
+      Text = 1,
+      StyleClass = 2,
+      ObjectName = 3,
+      Link = 4,
+      Inline = 5,
+      Hidden = 6,
+      Attribute = 7,
+      Bind = 8
+    };
+
+    /*! \brief Appends the nodes described by \p data to \p result.
+     */
+    static void read(const char* data, std::size_t len, CDWWidgetTemplate& result){
+      CDWTemplateReader r(data, len);
+      if(len < 4 || std::memcmp(data, "CDWT", 4) != 0)
+        throw WException("CDWTemplateReader: not a widget tree description");
+      r.pos = 4;
+      if(r.u8() != 1)
+        throw WException("CDWTemplateReader: unsupported version");
+
+      int base = (int)result.size();
+      std::uint32_t count = r.u32();
+      for(std::uint32_t i = 0; i < count; ++i){
+        std::uint8_t kind = r.u8();
+        if(kind > WidgetBreak)
+          throw WException("CDWTemplateReader: unknown widget kind");
+        std::int32_t parent = (std::int32_t)r.u32();
+        int index = result.add(parent < 0 ? -1 : base + parent, (CDWWidgetKind)kind);
+        CDWWidgetNode& node = result.node(index);
+
+        std::uint8_t properties = r.u8();
+        for(std::uint8_t p = 0; p < properties; ++p){
+          switch(r.u8()){
+          case Text:
+            node.text = r.text();
+            break;
+          case StyleClass:
+            node.styleClass = r.string();
+            break;
+          case ObjectName:
+            node.objectName = r.string();
+            break;
+          case Link:
+            node.link = WLink(r.string());
+            break;
+          case Inline:
+            node.inlineValue = true;
+            break;
+          case Hidden:
+            node.hidden = true;
+            break;
+          case Attribute: {
+            std::string name = r.string();
+            node.attributes.push_back(std::make_pair(name, r.text()));
+            break;
+          }
+          case Bind: {
+            std::uint8_t event = r.u8();
+            if(event > EventChanged)
+              throw WException("CDWTemplateReader: unknown event");
+            if(!CDWWidgetTemplate::canBind(node.kind, (CDWWidgetEvent)event))
+              throw WException("CDWTemplateReader: widget kind cannot emit the bound event");
+            node.bindings.push_back(std::make_pair((CDWWidgetEvent)event, (int)(std::int32_t)r.u32()));
+            break;
+          }
+          default:
+            throw WException("CDWTemplateReader: unknown property");
+          }
+        }
+      }
+    }
+
+  private:
+    const unsigned char* data;
+    std::size_t len;
+    std::size_t pos;
+
+    CDWTemplateReader(const char* data, std::size_t len)
+      : data((const unsigned char*)data), len(len), pos(0) {}
+
+    void need(std::size_t n){
+      if(len - pos < n)
+        throw WException("CDWTemplateReader: truncated description");
+    }
+
+    std::uint8_t u8(){
+      need(1);
+      return data[pos++];
+    }
+
+    std::uint32_t u32(){
+      need(4);
+      std::uint32_t v = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16)
+        | ((std::uint32_t)data[pos + 3] << 24);
+      pos += 4;
+      return v;
+    }
+
+    std::string string(){
+      std::uint32_t n = u32();
+      need(n);
+      std::string s((const char*)data + pos, n);
+      pos += n;
+      return s;
+    }
+
+    WString text(){
+      std::uint32_t n = u32();
+      need(n);
+      WString s = utf8String((const char*)data + pos, n);
+      pos += n;
+      return s;
+    }
+  };
+}
+
+#endif /* CDWTEMPLATEREADER_H_ */
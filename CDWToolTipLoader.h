@@ -0,0 +1,169 @@
+/*
+ * CDWToolTipLoader.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWTOOLTIPLOADER_H_
+#define CDWTOOLTIPLOADER_H_
+
+#include <Wt/WApplication>
+#include <Wt/WJavaScript>
+#include <Wt/WWebWidget>
+
+#include <string>
+
+namespace Wt {
+  class CDWApplication;
+
+  /*! \brief Callback resolving a deferred tooltip key to its text.
+   *
+   * The returned text is UTF-8 and is copied before the provider is
+   * called again, so it only needs to stay valid until the provider
+   * returns. Returning \c 0 yields an empty tooltip.
+   */
+  typedef const char* (*CDWToolTipProvider)(const char* key, void* userData);
+
+  /*! \brief Per-application loader for deferred (on-demand) tooltips.
+   *
+   * Areas using CDWAbstractArea::setDeferredToolTip() only ship a short
+   * key to the browser, as their title prefixed with \c "cdwtt:". A
+   * single delegated mouseover listener serves all image maps of the
+   * session: the first time the user hovers an area with a key, it takes
+   * the key out of the title and queues it on the client; queued keys are
+   * sent to the server in batches, resolved through the provider and
+   * cached on the client, so each key crosses the wire at most once per
+   * session.
+   *
+   * The listener is installed by auto JavaScript, so it is installed
+   * again when the page is fully rendered anew, e.g. after a reload.
+   *
+   * The loader is a child object of the application, created on first
+   * use by instance(), and kept by the application's wrapper.
+   */
+  class CDWToolTipLoader : public WObject{
+  public:
+    /*! \brief Maximum number of keys resolved per request.
+     */
+    enum { MaxBatch = 256 };
+
+    /*! \brief Prefix of a deferred tooltip key in an area's title.
+     */
+    static const char* marker(){
+      return "cdwtt:";
+    }
+
+    /*! \brief Returns the loader of the current application.
+     *
+     * The loader is created the first time this is called within a
+     * session. Defined in CDWApplication.h, see
+     * CDWApplication::toolTipLoader().
+     */
+    static CDWToolTipLoader* instance();
+
+    /*! \brief Sets the provider used to resolve tooltip keys.
+     */
+    void setProvider(CDWToolTipProvider provider, void* userData = 0){
+      this->provider = provider;
+      this->userData = userData;
+    }
+
+  private:
+    friend class CDWApplication;
+
+    WApplication* app;
+    JSignal<std::string> requested;
+    CDWToolTipProvider provider;
+    void* userData;
+
+    CDWToolTipLoader(WApplication* app)
+      : WObject(app),
+        app(app),
+        requested(app, "cdwToolTip"),
+        provider(0),
+        userData(0)
+    {
+      /*
+       * Keys hovered within the same 50 ms window are sent together, at
+       * most MaxBatch per request; resolved texts are cached in
+       * this.cdwTT.cache and applied to every area still waiting.
+       */
+      std::string batch = std::to_string((int)MaxBatch);
+      app->declareJavaScriptFunction("cdwToolTip",
+          "function(o,k){"
+            "var T=this.cdwTT||(this.cdwTT={cache:{},queue:[],wait:[],timer:null});"
+            "if(T.cache.hasOwnProperty(k)){o.title=o.cdwttText=T.cache[k];return;}"
+            "if(T.wait.indexOf(o)==-1)T.wait.push(o);"
+            "if(T.queue.indexOf(k)==-1)T.queue.push(k);"
+            "function send(){"
+              "T.timer=null;var q=T.queue.splice(0," + batch + ");"
+              "if(T.queue.length)T.timer=setTimeout(send,50);"
+              + requested.createCall("q.join('\\n')") + ";"
+            "}"
+            "if(!T.timer)T.timer=setTimeout(send,50);"
+          "}");
+      app->declareJavaScriptFunction("cdwToolTipsLoaded",
+          "function(m){"
+            "var T=this.cdwTT;if(!T)return;"
+            "for(var k in m)T.cache[k]=m[k];"
+            "var w=[];"
+            "for(var i=0;i<T.wait.length;++i){"
+              "var o=T.wait[i],k=o.cdwtt;"
+              "if(k&&T.cache.hasOwnProperty(k))o.title=o.cdwttText=T.cache[k];"
+              "else if(k&&document.body.contains(o))w.push(o);"
+            "}"
+            "T.wait=w;"
+          "}");
+      /*
+       * Installs the listener once per page: a full render starts anew. A
+       * title that is neither a key nor the text set here was set by the
+       * server, and ends the area's deferred tooltip.
+       */
+      std::string marker = CDWToolTipLoader::marker();
+      app->declareJavaScriptFunction("cdwToolTipListen",
+          "function(){"
+            "if(this.cdwTTListening)return;"
+            "this.cdwTTListening=true;"
+            "var A=this;"
+            "document.addEventListener('mouseover',function(e){"
+              "var o=e.target;"
+              "if(!o||o.tagName!='AREA')return;"
+              "var t=o.title;"
+              "if(t&&t.indexOf('" + marker + "')==0){"
+                "o.cdwtt=t.substring(" + std::to_string((int)marker.size()) + ");"
+                "o.title=o.cdwttText='';"
+              "}else if(t!==(o.cdwttText||''))o.cdwtt=null;"
+              "if(o.cdwtt)A.cdwToolTip(o,o.cdwtt);"
+            "},false);"
+          "}");
+      app->addAutoJavaScript(app->javaScriptClass() + ".cdwToolTipListen();");
+      requested.connect(this, &CDWToolTipLoader::load);
+    }
+
+    void load(std::string keys){
+      std::string js = app->javaScriptClass() + ".cdwToolTipsLoaded({";
+      int count = 0;
+      std::size_t begin = 0;
+      while(begin <= keys.size() && count < MaxBatch){
+        std::size_t end = keys.find('\n', begin);
+        if(end == std::string::npos)
+          end = keys.size();
+        if(end > begin){
+          std::string key = keys.substr(begin, end - begin);
+          const char* text = provider ? provider(key.c_str(), userData) : 0;
+          if(count)
+            js += ',';
+          js += WWebWidget::jsStringLiteral(key) + ":"
+              + WWebWidget::jsStringLiteral(text ? text : "");
+          ++count;
+        }
+        begin = end + 1;
+      }
+      js += "});";
+      if(count)
+        app->doJavaScript(js);
+    }
+  };
+}
+
+#endif /* CDWTOOLTIPLOADER_H_ */
@@ -0,0 +1,165 @@
+/*
+ * CDWUrlCache.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWURLCACHE_H_
+#define CDWURLCACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace Wt {
+
+  /*! \brief URL cache statistics of a session.
+   */
+  struct CDWUrlCacheStats{
+    std::uint64_t hits;
+    std::uint64_t misses;
+    std::uint64_t invalidations;
+  };
+
+  /*! \brief Memo of the URLs generated by a session.
+   *
+   * Maps (kind, argument) to the URL %Wt generated for it. A generated URL
+   * depends on the session id, on the deployment path and on the URL
+   * rewriting mode: whether the session id is carried in the URL (no
+   * cookies, or not yet known) and the Ajax mode. validate() is given that
+   * state before each lookup, and invalidates the cache when it changed.
+   *
+   * Relative URLs also climb out of the current internal path, with one
+   * "../" per path separator, unless internal paths are carried in URL
+   * fragments. Such URLs are cached per path depth, given to find(), so
+   * that navigating does not invalidate the cache.
+   *
+   * The strings returned by find() and insert() are owned by the cache.
+   * Neither an invalidation nor a full cache frees them at once: the
+   * entries move to a previous generation, which find() still searches
+   * while the state is unchanged, and which is dropped by the next
+   * invalidation or overflow. A returned string thus stays valid until
+   * the cache was invalidated or filled up twice since.
+   *
+   * Used from within the session only.
+   */
+  class CDWUrlCache{
+  public:
+    /*! \brief The function that generated a URL.
+     */
+    enum Kind {
+      SessionUrl,  //!< WApplication::url()
+      BookmarkUrl, //!< WApplication::bookmarkUrl()
+      AbsoluteUrl, //!< WApplication::makeAbsoluteUrl()
+      ResolvedUrl  //!< WApplication::resolveRelativeUrl()
+    };
+
+    CDWUrlCache(std::size_t maxEntries = 4096)
+      : maxEntries(maxEntries), cookies(false), ajax(false), previousValid(false) {
+      stats.hits = stats.misses = stats.invalidations = 0;
+    }
+
+    /*! \brief Checks the session state the URLs depend on.
+     */
+    void validate(const std::string& sessionId, const std::string& deploymentPath,
+                  bool cookies, bool ajax){
+      if(sessionId == this->sessionId && deploymentPath == this->deploymentPath
+         && cookies == this->cookies && ajax == this->ajax)
+        return;
+      invalidate();
+      this->sessionId = sessionId;
+      this->deploymentPath = deploymentPath;
+      this->cookies = cookies;
+      this->ajax = ajax;
+    }
+
+    /*! \brief Returns the number of path separators in an internal path.
+     */
+    static int depth(const std::string& internalPath){
+      int result = 0;
+      for(std::size_t i = 0; i < internalPath.size(); ++i)
+        if(internalPath[i] == '/')
+          ++result;
+      return result;
+    }
+
+    /*! \brief Returns the cached URL, or \c 0.
+     *
+     * \p depth is the depth() of the current internal path for URLs that
+     * depend on it, or -1.
+     */
+    const char* find(Kind kind, int depth, const char* argument){
+      key.assign(1, (char)('0' + kind));
+      appendNumber(depth + 1);
+      key += ':';
+      key += argument;
+      std::unordered_map<std::string, std::string>::const_iterator i = entries.find(key);
+      if(i == entries.end()){
+        if(previousValid)
+          i = previous.find(key);
+        if(!previousValid || i == previous.end()){
+          ++stats.misses;
+          return 0;
+        }
+      }
+      ++stats.hits;
+      return i->second.c_str();
+    }
+
+    /*! \brief Caches a URL, after a failed find() with the same key.
+     */
+    const char* insert(const std::string& url){
+      if(entries.size() >= maxEntries){
+        retire();
+        previousValid = true;
+      }
+      return entries.insert(std::make_pair(key, url)).first->second.c_str();
+    }
+
+    /*! \brief Invalidates all entries.
+     *
+     * Their strings are kept until the next invalidation or overflow.
+     */
+    void invalidate(){
+      if(!entries.empty() || previousValid){
+        retire();
+        previousValid = false;
+        ++stats.invalidations;
+      }
+    }
+
+    const CDWUrlCacheStats& statistics() const {
+      return stats;
+    }
+
+  private:
+    std::size_t maxEntries;
+    std::unordered_map<std::string, std::string> entries;
+    std::unordered_map<std::string, std::string> previous;
+    std::string key;
+    std::string sessionId;
+    std::string deploymentPath;
+    bool cookies;
+    bool ajax;
+    bool previousValid; //!< Whether previous holds URLs of the current state
+    CDWUrlCacheStats stats;
+
+    void retire(){
+      previous.clear();
+      previous.swap(entries);
+    }
+
+    void appendNumber(int n){
+      char digits[12];
+      int count = 0;
+      do {
+        digits[count++] = (char)('0' + n % 10);
+        n /= 10;
+      } while(n > 0);
+      while(count > 0)
+        key += digits[--count];
+    }
+  };
+}
+
+#endif /* CDWURLCACHE_H_ */
@@ -0,0 +1,378 @@
+/*
+ * CDWUtf8.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWUTF8_H_
+#define CDWUTF8_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CDWUTF8_X86 1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#endif
+
+namespace Wt {
+
+  /*! \brief UTF-8 validation and UTF-8 <-> wchar_t transcoding.
+   *
+   * These are the kernels used for strings crossing the binding. On x86
+   * they validate 16 bytes per step with the lookup-table algorithm of
+   * Keiser and Lemire (as used by simdutf) when the CPU supports SSSE3,
+   * and move runs of ASCII with SSE2. Other platforms use the scalar
+   * versions, which give the same results.
+   *
+   * wchar_t is UTF-32 where it is 4 bytes wide and UTF-16 where it is 2
+   * bytes wide (Windows).
+   */
+  namespace CDWUtf8 {
+
+    namespace detail {
+
+      /*
+       * Decodes one code point starting at s[i], advancing i. Invalid or
+       * truncated sequences yield U+FFFD and consume a single byte.
+       */
+      inline unsigned decode(const unsigned char* s, std::size_t len, std::size_t& i){
+        unsigned c = s[i];
+        if(c < 0x80){
+          ++i;
+          return c;
+        }
+
+        std::size_t n;
+        unsigned cp, lo = 0x80, hi = 0xBF;
+        if(c >= 0xC2 && c <= 0xDF){
+          n = 1; cp = c & 0x1F;
+        } else if(c >= 0xE0 && c <= 0xEF){
+          n = 2; cp = c & 0x0F;
+          if(c == 0xE0) lo = 0xA0;
+          if(c == 0xED) hi = 0x9F;
+        } else if(c >= 0xF0 && c <= 0xF4){
+          n = 3; cp = c & 0x07;
+          if(c == 0xF0) lo = 0x90;
+          if(c == 0xF4) hi = 0x8F;
+        } else {
+          ++i;
+          return 0xFFFD;
+        }
+
+        if(i + n >= len){
+          ++i;
+          return 0xFFFD;
+        }
+        for(std::size_t k = 1; k <= n; ++k){
+          unsigned b = s[i + k];
+          if(b < lo || b > hi){
+            ++i;
+            return 0xFFFD;
+          }
+          lo = 0x80; hi = 0xBF;
+          cp = (cp << 6) | (b & 0x3F);
+        }
+        i += n + 1;
+        return cp;
+      }
+
+      inline bool validateScalar(const unsigned char* s, std::size_t len){
+        std::size_t i = 0;
+        while(i < len){
+          if(s[i] < 0x80){
+            ++i;
+            continue;
+          }
+          std::size_t start = i;
+          if(decode(s, len, i) == 0xFFFD && i == start + 1)
+            return false;
+        }
+        return true;
+      }
+
+      inline void putWide(unsigned cp, wchar_t*& o){
+        if(sizeof(wchar_t) == 2 && cp > 0xFFFF){
+          cp -= 0x10000;
+          *o++ = (wchar_t)(0xD800 + (cp >> 10));
+          *o++ = (wchar_t)(0xDC00 + (cp & 0x3FF));
+        } else
+          *o++ = (wchar_t)cp;
+      }
+
+      inline std::size_t fromWideScalar(const wchar_t* s, std::size_t len, char* out){
+        char* o = out;
+        for(std::size_t i = 0; i < len; ++i){
+          unsigned cp = (unsigned)s[i];
+          if(sizeof(wchar_t) == 2 && cp >= 0xD800 && cp <= 0xDBFF && i + 1 < len
+             && (unsigned)s[i + 1] >= 0xDC00 && (unsigned)s[i + 1] <= 0xDFFF){
+            cp = 0x10000 + ((cp - 0xD800) << 10) + ((unsigned)s[i + 1] - 0xDC00);
+            ++i;
+          }
+          if((cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF)
+            cp = 0xFFFD;
+
+          if(cp < 0x80)
+            *o++ = (char)cp;
+          else if(cp < 0x800){
+            *o++ = (char)(0xC0 | (cp >> 6));
+            *o++ = (char)(0x80 | (cp & 0x3F));
+          } else if(cp < 0x10000){
+            *o++ = (char)(0xE0 | (cp >> 12));
+            *o++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+            *o++ = (char)(0x80 | (cp & 0x3F));
+          } else {
+            *o++ = (char)(0xF0 | (cp >> 18));
+            *o++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+            *o++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+            *o++ = (char)(0x80 | (cp & 0x3F));
+          }
+        }
+        return o - out;
+      }
+
+#ifdef CDWUTF8_X86
+      __attribute__((target("ssse3")))
+      inline __m128i lookup(__m128i table, __m128i index){
+        return _mm_shuffle_epi8(table, index);
+      }
+
+      __attribute__((target("ssse3")))
+      inline __m128i high(__m128i v){
+        return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+      }
+
+      /*
+       * Returns a non-zero vector when the 16 bytes in `input`, preceded by
+       * `prev`, contain an invalid sequence (not counting a sequence that
+       * continues into the next block).
+       */
+      __attribute__((target("ssse3")))
+      inline __m128i checkBlock(__m128i input, __m128i prev){
+        const char TOO_SHORT = 1 << 0, TOO_LONG = 1 << 1, OVERLONG_3 = 1 << 2,
+            TOO_LARGE = 1 << 3, SURROGATE = 1 << 4, OVERLONG_2 = 1 << 5,
+            TOO_LARGE_1000 = 1 << 6, OVERLONG_4 = 1 << 6, TWO_CONTS = (char)(1 << 7);
+        const char CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+        __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+        __m128i byte1High = lookup(_mm_setr_epi8(
+            TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+            TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+            TOO_SHORT | OVERLONG_2,
+            TOO_SHORT,
+            TOO_SHORT | OVERLONG_3 | SURROGATE,
+            TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4), high(prev1));
+        __m128i byte1Low = lookup(_mm_setr_epi8(
+            CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+            CARRY | OVERLONG_2,
+            CARRY,
+            CARRY,
+            CARRY | TOO_LARGE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+            CARRY | TOO_LARGE | TOO_LARGE_1000,
+            CARRY | TOO_LARGE | TOO_LARGE_1000), _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+        __m128i byte2High = lookup(_mm_setr_epi8(
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+            TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT), high(input));
+        __m128i special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+        /* Bytes that must be the 2nd or 3rd continuation of a 3/4 byte sequence. */
+        __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+        __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+        __m128i must23 = _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xE0 - 0x80))),
+                                      _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xF0 - 0x80))));
+        __m128i must23_80 = _mm_and_si128(must23, _mm_set1_epi8((char)0x80));
+        return _mm_xor_si128(must23_80, special);
+      }
+
+      /* Non-zero when the block ends inside a multi-byte sequence. */
+      __attribute__((target("ssse3")))
+      inline __m128i incomplete(__m128i input){
+        return _mm_subs_epu8(input, _mm_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1)));
+      }
+
+      __attribute__((target("ssse3")))
+      inline bool validateSsse3(const unsigned char* s, std::size_t len){
+        __m128i error = _mm_setzero_si128();
+        __m128i prev = _mm_setzero_si128();
+        __m128i prevIncomplete = _mm_setzero_si128();
+        std::size_t i = 0;
+        for(;; i += 16){
+          __m128i input;
+          bool last = i + 16 > len;
+          if(!last)
+            input = _mm_loadu_si128((const __m128i*)(s + i));
+          else {
+            /* Zero padding is ASCII, which flags sequences cut off at the end. */
+            unsigned char buffer[16] = { 0 };
+            std::memcpy(buffer, s + i, len - i);
+            input = _mm_loadu_si128((const __m128i*)buffer);
+          }
+
+          if(_mm_movemask_epi8(input) == 0)
+            error = _mm_or_si128(error, prevIncomplete);
+          else
+            error = _mm_or_si128(error, checkBlock(input, prev));
+          prevIncomplete = incomplete(input);
+          prev = input;
+
+          if(last)
+            break;
+        }
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+      }
+
+      inline bool hasSsse3(){
+        static const bool supported = __builtin_cpu_supports("ssse3");
+        return supported;
+      }
+
+      /* Widens leading ASCII 16 bytes at a time, returns the bytes consumed. */
+      inline std::size_t asciiToWide(const unsigned char* s, std::size_t len, wchar_t* out){
+        std::size_t i = 0;
+        const __m128i zero = _mm_setzero_si128();
+        for(; i + 16 <= len; i += 16){
+          __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+          if(_mm_movemask_epi8(v))
+            break;
+          __m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+          if(sizeof(wchar_t) == 2){
+            _mm_storeu_si128((__m128i*)(out + i), lo);
+            _mm_storeu_si128((__m128i*)(out + i + 8), hi);
+          } else {
+            _mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi16(lo, zero));
+            _mm_storeu_si128((__m128i*)(out + i + 4), _mm_unpackhi_epi16(lo, zero));
+            _mm_storeu_si128((__m128i*)(out + i + 8), _mm_unpacklo_epi16(hi, zero));
+            _mm_storeu_si128((__m128i*)(out + i + 12), _mm_unpackhi_epi16(hi, zero));
+          }
+        }
+        return i;
+      }
+
+      /* Narrows leading ASCII 16 characters at a time, returns the characters consumed. */
+      inline std::size_t asciiFromWide(const wchar_t* s, std::size_t len, char* out){
+        std::size_t i = 0;
+        const __m128i zero = _mm_setzero_si128();
+        const std::size_t perVector = 16 / sizeof(wchar_t);
+        const __m128i nonAscii = sizeof(wchar_t) == 2 ? _mm_set1_epi16((short)0xFF80)
+                                                      : _mm_set1_epi32((int)0xFFFFFF80);
+        for(; i + 16 <= len; i += 16){
+          __m128i v[4];
+          __m128i any = zero;
+          for(std::size_t k = 0; k < 16 / perVector; ++k){
+            v[k] = _mm_loadu_si128((const __m128i*)(s + i + k * perVector));
+            any = _mm_or_si128(any, v[k]);
+          }
+          if(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(any, nonAscii), zero)) != 0xFFFF)
+            break;
+          __m128i bytes = sizeof(wchar_t) == 2
+              ? _mm_packus_epi16(v[0], v[1])
+              : _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+          _mm_storeu_si128((__m128i*)(out + i), bytes);
+        }
+        return i;
+      }
+#endif
+    }
+
+    /*! \brief Returns whether \p len bytes at \p utf8 are valid UTF-8.
+     *
+     * Overlong encodings, surrogates and code points above U+10FFFF are
+     * rejected.
+     */
+    inline bool validate(const char* utf8, std::size_t len){
+      const unsigned char* s = (const unsigned char*)utf8;
+#ifdef CDWUTF8_X86
+      if(detail::hasSsse3())
+        return detail::validateSsse3(s, len);
+#endif
+      return detail::validateScalar(s, len);
+    }
+
+    /*! \brief Converts UTF-8 to wchar_t, returns the number of characters
+     *         written.
+     *
+     * \p out must have room for \p len characters. Invalid sequences are
+     * replaced by U+FFFD.
+     */
+    inline std::size_t toWide(const char* utf8, std::size_t len, wchar_t* out){
+      const unsigned char* s = (const unsigned char*)utf8;
+      wchar_t* o = out;
+      std::size_t done = 0;
+      while(done < len){
+#ifdef CDWUTF8_X86
+        std::size_t ascii = detail::asciiToWide(s + done, len - done, o);
+        done += ascii;
+        o += ascii;
+#endif
+        /* At least one code point, then retry the vectorized ASCII path. */
+        std::size_t stop = std::min(len, done + 16);
+        while(done < stop)
+          detail::putWide(detail::decode(s, len, done), o);
+      }
+      return o - out;
+    }
+
+    /*! \brief Converts wchar_t to UTF-8, returns the number of bytes
+     *         written.
+     *
+     * \p out must have room for 4 * \p len bytes. Unpaired surrogates are
+     * replaced by U+FFFD.
+     */
+    inline std::size_t fromWide(const wchar_t* wide, std::size_t len, char* out){
+      std::size_t done = 0, written = 0;
+      while(done < len){
+#ifdef CDWUTF8_X86
+        std::size_t ascii = detail::asciiFromWide(wide + done, len - done, out + written);
+        done += ascii;
+        written += ascii;
+#endif
+        std::size_t end = std::min(len, done + 16);
+        /* Keep surrogate pairs together. */
+        if(sizeof(wchar_t) == 2 && end < len
+           && (unsigned)wide[end - 1] >= 0xD800 && (unsigned)wide[end - 1] <= 0xDBFF)
+          ++end;
+        written += detail::fromWideScalar(wide + done, end - done, out + written);
+        done = end;
+      }
+      return written;
+    }
+
+    /*! \brief Converts a UTF-8 string to a wide string.
+     */
+    inline std::wstring toWString(const std::string& utf8){
+      std::wstring result(utf8.size(), L'\0');
+      if(!utf8.empty())
+        result.resize(toWide(utf8.data(), utf8.size(), &result[0]));
+      return result;
+    }
+
+    /*! \brief Converts a wide string to a UTF-8 string.
+     */
+    inline std::string fromWString(const std::wstring& wide){
+      std::string result(wide.size() * 4, '\0');
+      if(!wide.empty())
+        result.resize(fromWide(wide.data(), wide.size(), &result[0]));
+      return result;
+    }
+  }
+}
+
+#endif /* CDWUTF8_H_ */
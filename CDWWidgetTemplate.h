@@ -0,0 +1,260 @@
+/*
+ * CDWWidgetTemplate.h
+ *
+ *  Created on: 18-oct.-2026
+ */
+
+#ifndef CDWWIDGETTEMPLATE_H_
+#define CDWWIDGETTEMPLATE_H_
+
+#include <Wt/WAnchor>
+#include <Wt/WBreak>
+#include <Wt/WContainerWidget>
+#include <Wt/WException>
+#include <Wt/WFormWidget>
+#include <Wt/WImage>
+#include <Wt/WLabel>
+#include <Wt/WLineEdit>
+#include <Wt/WLink>
+#include <Wt/WPushButton>
+#include <Wt/WString>
+#include <Wt/WText>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Wt {
+
+  /*! \brief Widget types a CDWWidgetTemplate can create.
+   */
+  enum CDWWidgetKind {
+    WidgetContainer,  //!< WContainerWidget
+    WidgetText,       //!< WText
+    WidgetPushButton, //!< WPushButton
+    WidgetLineEdit,   //!< WLineEdit
+    WidgetAnchor,     //!< WAnchor
+    WidgetImage,      //!< WImage
+    WidgetLabel,      //!< WLabel
+    WidgetBreak       //!< WBreak
+  };
+
+  /*! \brief Signals a CDWWidgetTemplate can bind to listener ids.
+   */
+  enum CDWWidgetEvent {
+    EventClicked,       //!< WInteractWidget::clicked()
+    EventDoubleClicked, //!< WInteractWidget::doubleClicked()
+    EventEnterPressed,  //!< WInteractWidget::enterPressed()
+    EventEscapePressed, //!< WInteractWidget::escapePressed()
+    EventMouseWentOver, //!< WInteractWidget::mouseWentOver()
+    EventChanged        //!< WFormWidget::changed()
+  };
+
+  /*! \brief Called when a bound signal of an instantiated widget fires.
+   *
+   * \p listenerId is the id bound in the template, \p node the index of
+   * the widget's node.
+   */
+  typedef void (*CDWTemplateListener)(int listenerId, int node, void* userData);
+
+  /*! \brief A recorded widget of a CDWWidgetTemplate.
+   */
+  struct CDWWidgetNode{
+    CDWWidgetKind kind;
+    int parent;              //!< Index of the parent node, -1 for a top-level node
+    WString text;            //!< Text, label or placeholder
+    WLink link;              //!< Link of an anchor, or image
+    std::string styleClass;
+    std::string objectName;
+    bool inlineValue;
+    bool hidden;
+    std::vector<std::pair<std::string, WString> > attributes;
+    std::vector<std::pair<CDWWidgetEvent, int> > bindings; //!< Signal to listener id
+  };
+
+  /*! \brief A recorded widget tree that is replayed for every session.
+   *
+   * Most sessions build the same initial widget tree. A template records
+   * that tree once, typically at startup, with all its strings already
+   * converted; instantiate() then creates the widgets in one pass over a
+   * flat node array: no formatting, no lookups, no string conversions,
+   * and the subtree is only attached to its parent when complete.
+   *
+   * \code
+   * static CDWWidgetTemplate header;
+   * int bar = header.add(-1, WidgetContainer, "", "toolbar");
+   * header.add(bar, WidgetText, "<b>Orders</b>");
+   * header.add(bar, WidgetPushButton, "New order", "btn");
+   * ...
+   * std::vector<WWidget*> widgets;
+   * header.instantiate(app->root(), widgets);
+   * \endcode
+   *
+   * After it is built, a template is immutable and may be instantiated by
+   * any number of sessions concurrently.
+   *
+   * \sa CDWApplication::instantiate()
+   */
+  class CDWWidgetTemplate{
+  public:
+    /*! \brief Records a widget, returns its node index.
+     *
+     * \p parent must be a container node added before, or -1 for a
+     * top-level widget. \p utf8Text is the text of a text, button or
+     * label, and the placeholder of a line edit.
+     */
+    int add(int parent, CDWWidgetKind kind, const std::string& utf8Text = "",
+            const std::string& styleClass = ""){
+      if(parent >= (int)nodes.size() || (parent >= 0 && nodes[parent].kind != WidgetContainer))
+        throw WException("CDWWidgetTemplate: parent is not a container");
+
+      CDWWidgetNode n;
+      n.kind = kind;
+      n.parent = parent;
+      n.text = WString::fromUTF8(utf8Text);
+      n.styleClass = styleClass;
+      n.inlineValue = false;
+      n.hidden = false;
+      nodes.push_back(n);
+      return (int)nodes.size() - 1;
+    }
+
+    /*! \brief Returns a node, to set its other properties.
+     */
+    CDWWidgetNode& node(int index){
+      return nodes[index];
+    }
+
+    const CDWWidgetNode& node(int index) const {
+      return nodes[index];
+    }
+
+    std::size_t size() const {
+      return nodes.size();
+    }
+
+    /*! \brief Returns whether widgets of \p kind emit \p event.
+     *
+     * A binding to an event the widget cannot emit would never fire.
+     */
+    static bool canBind(CDWWidgetKind kind, CDWWidgetEvent event){
+      switch(kind){
+      case WidgetBreak:
+        return false;
+      case WidgetPushButton:
+      case WidgetLineEdit:
+        return true;
+      default:
+        return event != EventChanged;
+      }
+    }
+
+    /*! \brief Creates the widgets under \p parent.
+     *
+     * \p widgets receives the widget of every node, by node index. The
+     * signal bindings of the nodes are connected to \p listener.
+     */
+    void instantiate(WContainerWidget* parent, std::vector<WWidget*>& widgets,
+                     CDWTemplateListener listener = 0, void* userData = 0) const {
+      widgets.resize(nodes.size());
+      for(std::size_t i = 0; i < nodes.size(); ++i){
+        const CDWWidgetNode& n = nodes[i];
+        WWidget* w = create(n);
+        if(!n.styleClass.empty())
+          w->setStyleClass(n.styleClass);
+        if(!n.objectName.empty())
+          w->setObjectName(n.objectName);
+        if(n.inlineValue)
+          w->setInline(true);
+        if(n.hidden)
+          w->setHidden(true);
+        for(std::size_t a = 0; a < n.attributes.size(); ++a)
+          w->setAttributeValue(n.attributes[a].first, n.attributes[a].second);
+        if(listener)
+          for(std::size_t b = 0; b < n.bindings.size(); ++b)
+            bind(w, n.bindings[b].first, new Relay(w, listener, n.bindings[b].second, (int)i, userData));
+
+        if(n.parent >= 0)
+          static_cast<WContainerWidget*>(widgets[n.parent])->addWidget(w);
+        widgets[i] = w;
+      }
+
+      for(std::size_t i = 0; i < nodes.size(); ++i)
+        if(nodes[i].parent < 0)
+          parent->addWidget(widgets[i]);
+    }
+
+  private:
+    /* Forwards a signal to the listener; owned by the widget. */
+    class Relay : public WObject{
+    public:
+      Relay(WObject* parent, CDWTemplateListener listener, int listenerId, int node, void* userData)
+        : WObject(parent), listener(listener), listenerId(listenerId), node(node), userData(userData) {}
+
+      void fire(){
+        listener(listenerId, node, userData);
+      }
+
+    private:
+      CDWTemplateListener listener;
+      int listenerId;
+      int node;
+      void* userData;
+    };
+
+    std::vector<CDWWidgetNode> nodes;
+
+    static void bind(WWidget* w, CDWWidgetEvent event, Relay* relay){
+      WInteractWidget* iw = dynamic_cast<WInteractWidget*>(w);
+      WFormWidget* fw = dynamic_cast<WFormWidget*>(w);
+      switch(event){
+      case EventClicked:
+        if(iw) iw->clicked().connect(relay, &Relay::fire);
+        return;
+      case EventDoubleClicked:
+        if(iw) iw->doubleClicked().connect(relay, &Relay::fire);
+        return;
+      case EventEnterPressed:
+        if(iw) iw->enterPressed().connect(relay, &Relay::fire);
+        return;
+      case EventEscapePressed:
+        if(iw) iw->escapePressed().connect(relay, &Relay::fire);
+        return;
+      case EventMouseWentOver:
+        if(iw) iw->mouseWentOver().connect(relay, &Relay::fire);
+        return;
+      case EventChanged:
+        if(fw) fw->changed().connect(relay, &Relay::fire);
+        return;
+      }
+    }
+
+    static WWidget* create(const CDWWidgetNode& n){
+      switch(n.kind){
+      case WidgetContainer:
+        return new WContainerWidget();
+      case WidgetText:
+        return new WText(n.text);
+      case WidgetPushButton:
+        return new WPushButton(n.text);
+      case WidgetLineEdit: {
+        WLineEdit* edit = new WLineEdit();
+        if(!n.text.empty())
+          edit->setEmptyText(n.text);
+        return edit;
+      }
+      case WidgetAnchor:
+        return new WAnchor(n.link, n.text);
+      case WidgetImage:
+        return new WImage(n.link, n.text);
+      case WidgetLabel:
+        return new WLabel(n.text);
+      case WidgetBreak:
+        return new WBreak();
+      }
+      throw WException("CDWWidgetTemplate: unknown widget kind");
+    }
+  };
+}
+
+#endif /* CDWWIDGETTEMPLATE_H_ */